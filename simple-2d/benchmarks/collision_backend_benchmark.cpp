@@ -0,0 +1,106 @@
+// Measures each collision broadphase backend on a side-scrolling level: a scene 720 pixels high and as wide as needed
+// for about 2 bodies per 128 pixel cell, with bodies 16 to 64 pixels wide moving up to 2 pixels per tick and bouncing on
+// the borders of the scene. Each tick updates the backend and lists the candidate pairs, as the collision manager does.
+//
+// Usage: collision_backend_benchmark [grid|tree|sap|hash|all] [num_bodies]
+#include <simple-2d/collision/broadphase.h>
+#include <simple-2d/collision/spatial_hash.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define NUM_TICKS 100
+#define BENCHMARK_CELL_SIZE 128
+#define LEVEL_HEIGHT 720
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct Backend {
+    const char *name;
+    simple_2d::BroadphaseType type;
+};
+
+static const Backend BACKENDS[] = {
+    {"grid", simple_2d::UNIFORM_GRID_BROADPHASE},
+    {"tree", simple_2d::AABB_TREE_BROADPHASE},
+    {"sap", simple_2d::SWEEP_AND_PRUNE_BROADPHASE},
+    {"hash", simple_2d::SPATIAL_HASH_BROADPHASE},
+};
+
+static void runBackend(const Backend &backend, size_t numBodies) {
+    auto levelWidth = int(numBodies / 2.0 * BENCHMARK_CELL_SIZE * BENCHMARK_CELL_SIZE / LEVEL_HEIGHT);
+    simple_2d::RectangularDimensions<int> sceneDimensions = {levelWidth, LEVEL_HEIGHT};
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> positionX(0, float(levelWidth - 64));
+    std::uniform_real_distribution<float> positionY(0, float(LEVEL_HEIGHT - 64));
+    std::uniform_real_distribution<float> size(16, 64);
+    std::uniform_real_distribution<float> velocity(-2, 2);
+    simple_2d::AabbBuffer boxes;
+    std::vector<simple_2d::XYCoordinate<float>> velocities;
+    std::vector<simple_2d::EntityId> entities;
+    for (size_t i = 0; i < numBodies; i++) {
+        simple_2d::Rectangle<float> box;
+        box.top_left = {positionX(random), positionY(random)};
+        box.bottom_right = box.top_left + simple_2d::XYCoordinate<float>(size(random), size(random));
+        boxes.PushBack(box);
+        velocities.push_back({velocity(random), velocity(random)});
+        entities.push_back(simple_2d::MakeEntityId(uint32_t(i), 0));
+    }
+    auto broadphase = simple_2d::CreateBroadphase(backend.type, sceneDimensions, BENCHMARK_CELL_SIZE);
+    std::vector<simple_2d::CollisionPair> pairs;
+    double elapsed = 0;
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        for (size_t i = 0; i < numBodies; i++) {
+            auto &v = velocities[i];
+            if (boxes.minX[i] + v.x < 0 || boxes.maxX[i] + v.x > levelWidth) {
+                v.x = -v.x;
+            }
+            if (boxes.minY[i] + v.y < 0 || boxes.maxY[i] + v.y > LEVEL_HEIGHT) {
+                v.y = -v.y;
+            }
+            boxes.minX[i] += v.x;
+            boxes.maxX[i] += v.x;
+            boxes.minY[i] += v.y;
+            boxes.maxY[i] += v.y;
+        }
+        auto start = Clock::now();
+        broadphase->Update(entities, boxes, 0, simple_2d::CollisionBodyIndex(numBodies));
+        pairs.clear();
+        broadphase->FindPairs(pairs);
+        elapsed += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+    printf("%10s %10zu %12d %20.2f %12zu\n", backend.name, numBodies, levelWidth, elapsed / NUM_TICKS, pairs.size());
+    if (auto spatialHash = dynamic_cast<simple_2d::SpatialHash*>(broadphase.get())) {
+        auto stats = spatialHash->GetStats();
+        printf("%10s cell size %.0f, %zu occupied cells, %.2f bodies per cell (max %u), %.2f cells per body, %zu large bodies, %zu/%zu shared buckets\n",
+               "", stats.cellSize, stats.numOccupiedCells, stats.averageBodiesPerCell, stats.maxBodiesPerCell, stats.averageCellsPerBody, stats.numLargeBodies, stats.numSharedBuckets, stats.numBuckets);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *backendName = argc > 1 ? argv[1] : "all";
+    std::vector<size_t> numBodiesList = {1000, 10000, 100000};
+    if (argc > 2) {
+        numBodiesList = {size_t(std::strtoul(argv[2], nullptr, 10))};
+    }
+    std::vector<const Backend*> backends;
+    for (auto &backend : BACKENDS) {
+        if (std::strcmp(backendName, "all") == 0 || std::strcmp(backendName, backend.name) == 0) {
+            backends.push_back(&backend);
+        }
+    }
+    if (backends.empty()) {
+        fprintf(stderr, "Unknown backend %s, expected grid, tree, sap, hash or all\n", backendName);
+        return 1;
+    }
+    printf("%10s %10s %12s %20s %12s\n", "backend", "bodies", "level width", "time per tick (us)", "pairs");
+    for (auto backend : backends) {
+        for (auto numBodies : numBodiesList) {
+            runBackend(*backend, numBodies);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Measures the collision broadphase: binning every body into the scene grid and listing the pairs sharing a cell, once
+// per tick. Bodies are 16 to 64 pixels wide and spread over a scene scaled with their number, about 2 bodies per cell.
+// "map of sets" is the former implementation of CollisionBodyComponentManager: a std::map<cell, std::set<entity>> rebuilt
+// every tick, a vector of cell ids per body and a map of already seen pairs. "grid" is UniformGrid and "tree" AabbTree,
+// which also reports the pairs closer than twice its fat margin.
+#include <simple-2d/collision/uniform_grid.h>
+#include <simple-2d/collision/aabb_tree.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#define NUM_TICKS 20
+#define BENCHMARK_CELL_SIZE 128
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static std::vector<simple_2d::Rectangle<float>> createBoxes(size_t numBodies, simple_2d::RectangularDimensions<int> &sceneDimensions) {
+    auto sceneSize = int(std::sqrt(numBodies / 2.0) * BENCHMARK_CELL_SIZE);
+    sceneDimensions = {sceneSize, sceneSize};
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(0, float(sceneSize - 64));
+    std::uniform_real_distribution<float> size(16, 64);
+    std::vector<simple_2d::Rectangle<float>> boxes(numBodies);
+    for (auto &box : boxes) {
+        box.top_left = {position(random), position(random)};
+        box.bottom_right = box.top_left + simple_2d::XYCoordinate<float>(size(random), size(random));
+    }
+    return boxes;
+}
+
+static double stepMapOfSets(const std::vector<simple_2d::Rectangle<float>> &boxes, simple_2d::RectangularDimensions<int> sceneDimensions, size_t &numPairs) {
+    typedef uint32_t CollisionCellId;
+    uint32_t numCellsX = (sceneDimensions.width + BENCHMARK_CELL_SIZE - 1) / BENCHMARK_CELL_SIZE;
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        std::map<CollisionCellId, std::set<uint32_t>> cellEntitiesMap;
+        for (uint32_t entityId = 0; entityId < boxes.size(); entityId++) {
+            auto &box = boxes[entityId];
+            CollisionCellId minX = (CollisionCellId)(box.top_left.x / BENCHMARK_CELL_SIZE) + ((uint32_t)box.top_left.x % BENCHMARK_CELL_SIZE > 0);
+            CollisionCellId minY = (CollisionCellId)(box.top_left.y / BENCHMARK_CELL_SIZE) + ((uint32_t)box.top_left.y % BENCHMARK_CELL_SIZE > 0);
+            CollisionCellId maxX = (CollisionCellId)(box.bottom_right.x / BENCHMARK_CELL_SIZE) + ((uint32_t)box.bottom_right.x % BENCHMARK_CELL_SIZE > 0);
+            CollisionCellId maxY = (CollisionCellId)(box.bottom_right.y / BENCHMARK_CELL_SIZE) + ((uint32_t)box.bottom_right.y % BENCHMARK_CELL_SIZE > 0);
+            std::vector<CollisionCellId> cellIds;
+            for (auto y = minY; y <= maxY; y++) {
+                for (auto x = minX; x <= maxX; x++) {
+                    cellIds.push_back(y * numCellsX + x);
+                }
+            }
+            for (auto cellId : cellIds) {
+                cellEntitiesMap[cellId].insert(entityId);
+            }
+        }
+        std::map<uint32_t, std::set<uint32_t>> entityCollisionsMap;
+        numPairs = 0;
+        for (auto &[cellId, entityIds] : cellEntitiesMap) {
+            for (auto it = entityIds.begin(); it != entityIds.end(); it++) {
+                for (auto it2 = std::next(it); it2 != entityIds.end(); it2++) {
+                    if (entityCollisionsMap[*it].find(*it2) != entityCollisionsMap[*it].end()) {
+                        continue;
+                    }
+                    // The former code only remembered pairs which did collide. Remembering all of them here makes both
+                    // implementations report every pair once.
+                    entityCollisionsMap[*it].insert(*it2);
+                    numPairs++;
+                }
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    return elapsed.count() / NUM_TICKS;
+}
+
+static double stepGrid(const std::vector<simple_2d::Rectangle<float>> &boxes, simple_2d::RectangularDimensions<int> sceneDimensions, size_t &numPairs) {
+    simple_2d::UniformGrid grid;
+    grid.SetBounds(sceneDimensions, BENCHMARK_CELL_SIZE);
+    simple_2d::AabbBuffer boxBuffer;
+    for (auto &box : boxes) {
+        boxBuffer.PushBack(box);
+    }
+    std::vector<simple_2d::CollisionPair> pairs;
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        grid.Build(boxBuffer);
+        pairs.clear();
+        grid.FindPairs(pairs);
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    numPairs = pairs.size();
+    return elapsed.count() / NUM_TICKS;
+}
+
+static double stepTree(const std::vector<simple_2d::Rectangle<float>> &boxes, size_t &numPairs) {
+    simple_2d::AabbTree tree;
+    simple_2d::AabbBuffer boxBuffer;
+    std::vector<simple_2d::EntityId> entities;
+    for (auto &box : boxes) {
+        boxBuffer.PushBack(box);
+        entities.push_back(simple_2d::MakeEntityId(uint32_t(entities.size()), 0));
+    }
+    std::vector<simple_2d::CollisionPair> pairs;
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        tree.Update(entities, boxBuffer, 0, simple_2d::CollisionBodyIndex(boxes.size()));
+        pairs.clear();
+        tree.FindPairs(pairs);
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    numPairs = pairs.size();
+    return elapsed.count() / NUM_TICKS;
+}
+
+int main() {
+    printf("%10s %20s %20s %20s %10s %12s %12s %12s\n", "bodies", "map of sets (us)", "grid (us)", "tree (us)", "speedup", "pairs (map)", "pairs (grid)", "pairs (tree)");
+    for (size_t numBodies : {1000, 10000, 100000}) {
+        simple_2d::RectangularDimensions<int> sceneDimensions;
+        auto boxes = createBoxes(numBodies, sceneDimensions);
+        size_t numPairsMap = 0;
+        size_t numPairsGrid = 0;
+        size_t numPairsTree = 0;
+        auto mapOfSets = stepMapOfSets(boxes, sceneDimensions, numPairsMap);
+        auto grid = stepGrid(boxes, sceneDimensions, numPairsGrid);
+        auto tree = stepTree(boxes, numPairsTree);
+        printf("%10zu %20.2f %20.2f %20.2f %9.2fx %12zu %12zu %12zu\n", numBodies, mapOfSets, grid, tree, mapOfSets / grid, numPairsMap, numPairsGrid, numPairsTree);
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Measures how long MotionComponentManager takes to step as the number of entities grows. The same workload is also run
+// on a std::map<EntityId, std::shared_ptr<MotionComponent>>, which is how component managers used to store components,
+// so both columns can be compared directly.
+// The second table measures spawn/despawn churn (add then remove every component, in shuffled order) on the sparse-set
+// and the hashed entity index of PackedComponentStorage.
+#include <simple-2d/core.h>
+#include <simple-2d/entity.h>
+#include <simple-2d/components/motion.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <memory>
+#include <vector>
+
+#define NUM_TICKS 100
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double stepPackedStorage(size_t numEntities) {
+    auto &engine = simple_2d::Engine::GetInstance();
+    auto scene = std::make_shared<simple_2d::Scene>(simple_2d::RectangularDimensions<int>{800, 600});
+    engine.SetCurrentScene(scene);
+    std::vector<simple_2d::Entity> entities(numEntities);
+    for (auto &entity : entities) {
+        entity.AddComponent(simple_2d::ComponentType::MOTION);
+        auto motion = static_cast<simple_2d::MotionComponent *>(entity.GetComponent(simple_2d::ComponentType::MOTION));
+        motion->SetVelocity(simple_2d::XYCoordinate<float>(1, 0));
+        motion->SetAcceleration(simple_2d::XYCoordinate<float>(0, 0.2));
+    }
+    auto motionComponentManager = scene->GetComponentManager(simple_2d::ComponentType::MOTION);
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        motionComponentManager->Step();
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    return elapsed.count() / NUM_TICKS;
+}
+
+static double stepMapOfSharedPointers(size_t numEntities) {
+    std::map<simple_2d::EntityId, std::shared_ptr<simple_2d::MotionComponent>> components;
+    for (simple_2d::EntityId id = 0; id < numEntities; id++) {
+        auto motion = std::make_shared<simple_2d::MotionComponent>(id);
+        motion->SetVelocity(simple_2d::XYCoordinate<float>(1, 0));
+        motion->SetAcceleration(simple_2d::XYCoordinate<float>(0, 0.2));
+        components[id] = motion;
+    }
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        for (auto &component : components) {
+            auto motion = std::static_pointer_cast<simple_2d::MotionComponent>(component.second);
+            motion->Step();
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    return elapsed.count() / NUM_TICKS;
+}
+
+template<typename EntityIndex>
+static double churnStorage(size_t numEntities) {
+    simple_2d::PackedComponentStorage<simple_2d::MotionComponent, EntityIndex> storage;
+    std::vector<simple_2d::EntityId> ids(numEntities);
+    for (size_t i = 0; i < numEntities; i++) {
+        ids[i] = simple_2d::EntityId(i);
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        for (auto id : ids) {
+            storage.Emplace(id);
+        }
+        for (auto it = ids.rbegin(); it != ids.rend(); it++) {
+            storage.Erase(*it);
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start);
+    return elapsed.count() / (NUM_TICKS * numEntities * 2);
+}
+
+int main() {
+    printf("%10s %20s %20s %10s\n", "entities", "packed (us/tick)", "map (us/tick)", "speedup");
+    for (size_t numEntities : {1000, 10000, 100000, 1000000}) {
+        auto packed = stepPackedStorage(numEntities);
+        auto map = stepMapOfSharedPointers(numEntities);
+        printf("%10zu %20.2f %20.2f %9.2fx\n", numEntities, packed, map, map / packed);
+    }
+    printf("\n%10s %20s %20s\n", "entities", "sparse (ns/op)", "hashed (ns/op)");
+    for (size_t numEntities : {1000, 10000, 100000}) {
+        auto sparse = churnStorage<simple_2d::SparseEntityIndex>(numEntities);
+        auto hashed = churnStorage<simple_2d::HashedEntityIndex>(numEntities);
+        printf("%10zu %20.2f %20.2f\n", numEntities, sparse, hashed);
+    }
+    return 0;
+}
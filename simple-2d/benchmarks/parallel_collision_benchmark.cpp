@@ -0,0 +1,102 @@
+// Measures how CollisionBodyComponentManager scales with the number of worker threads, in a crowded arena: dynamic bodies
+// packed between 4 static walls, moving in random directions and bumping into each other. Only the collision step is
+// timed. The positions reached after all ticks are checked against the single-threaded run: pairs are detected in
+// parallel but resolved in a fixed order, so they must be exactly the same.
+// Usage: parallel_collision_benchmark [max_threads] [num_bodies], max_threads defaults to the number of hardware threads.
+#include <simple-2d/core.h>
+#include <simple-2d/entity.h>
+#include <simple-2d/components/motion.h>
+#include <simple-2d/components/collision_body.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define NUM_TICKS 50
+#define BODY_SIZE 8
+// Distance between the top left corners of neighbouring bodies at the start
+#define BODY_SPACING 12
+#define WALL_THICKNESS 16
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double stepCollisions(size_t numThreads, size_t numBodies, std::vector<simple_2d::XYCoordinate<float>> &finalPositions) {
+    auto &engine = simple_2d::Engine::GetInstance();
+    engine.GetWorkerPool().SetNumThreads(numThreads);
+    auto bodiesPerRow = size_t(std::ceil(std::sqrt(double(numBodies))));
+    auto arenaSize = int(bodiesPerRow * BODY_SPACING + 2 * WALL_THICKNESS);
+    auto scene = std::make_shared<simple_2d::Scene>(simple_2d::RectangularDimensions<int>{arenaSize, arenaSize});
+    engine.SetCurrentScene(scene);
+    std::vector<simple_2d::Entity> bodies(numBodies);
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> velocity(-2, 2);
+    for (size_t i = 0; i < bodies.size(); i++) {
+        bodies[i].AddComponent<simple_2d::MotionComponent>();
+        bodies[i].AddComponent<simple_2d::CollisionBodyComponent>();
+        auto motion = bodies[i].GetComponent<simple_2d::MotionComponent>();
+        motion->SetPosition(simple_2d::XYCoordinate<float>(float(WALL_THICKNESS + (i % bodiesPerRow) * BODY_SPACING), float(WALL_THICKNESS + (i / bodiesPerRow) * BODY_SPACING)));
+        motion->SetVelocity(simple_2d::XYCoordinate<float>(velocity(random), velocity(random)));
+        bodies[i].GetComponent<simple_2d::CollisionBodyComponent>()->SetSize(simple_2d::RectangularDimensions<float>(BODY_SIZE, BODY_SIZE));
+    }
+    // Top, bottom, left and right
+    const simple_2d::Rectangle<float> wallBoxes[] = {
+        {{0, 0}, {float(arenaSize), WALL_THICKNESS}},
+        {{0, float(arenaSize - WALL_THICKNESS)}, {float(arenaSize), float(arenaSize)}},
+        {{0, 0}, {WALL_THICKNESS, float(arenaSize)}},
+        {{float(arenaSize - WALL_THICKNESS), 0}, {float(arenaSize), float(arenaSize)}},
+    };
+    std::vector<simple_2d::Entity> walls(4);
+    for (size_t i = 0; i < walls.size(); i++) {
+        walls[i].AddComponent<simple_2d::MotionComponent>();
+        walls[i].AddComponent<simple_2d::CollisionBodyComponent>();
+        walls[i].GetComponent<simple_2d::MotionComponent>()->SetPosition(wallBoxes[i].top_left);
+        auto collisionBody = walls[i].GetComponent<simple_2d::CollisionBodyComponent>();
+        collisionBody->SetSize(simple_2d::RectangularDimensions<float>(wallBoxes[i].bottom_right.x - wallBoxes[i].top_left.x, wallBoxes[i].bottom_right.y - wallBoxes[i].top_left.y));
+        collisionBody->SetBodyType(simple_2d::CollisionBodyComponent::Static);
+    }
+    auto motionComponentManager = scene->GetComponentManager<simple_2d::MotionComponent>();
+    auto collisionBodyComponentManager = scene->GetComponentManager<simple_2d::CollisionBodyComponent>();
+    // Warm up, so that starting the threads and growing the buffers is not measured
+    collisionBodyComponentManager->Step();
+    motionComponentManager->Step();
+    double elapsed = 0;
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        auto start = Clock::now();
+        collisionBodyComponentManager->Step();
+        elapsed += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        motionComponentManager->Step();
+    }
+    finalPositions.clear();
+    for (auto &body : bodies) {
+        finalPositions.push_back(body.GetComponent<simple_2d::MotionComponent>()->GetPosition());
+    }
+    return elapsed / NUM_TICKS;
+}
+
+int main(int argc, char *argv[]) {
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 1) {
+        maxThreads = std::max(1, atoi(argv[1]));
+    }
+    size_t numBodies = 20000;
+    if (argc > 2) {
+        numBodies = size_t(std::strtoul(argv[2], nullptr, 10));
+    }
+    std::vector<simple_2d::XYCoordinate<float>> referencePositions;
+    std::vector<simple_2d::XYCoordinate<float>> positions;
+    auto reference = stepCollisions(1, numBodies, referencePositions);
+    printf("%10s %15s %10s %15s\n", "threads", "us/tick", "speedup", "deterministic");
+    printf("%10d %15.2f %9.2fx %15s\n", 1, reference, 1.0, "yes");
+    for (size_t numThreads = 2; numThreads <= maxThreads; numThreads *= 2) {
+        auto elapsed = stepCollisions(numThreads, numBodies, positions);
+        auto isSame = std::equal(positions.begin(), positions.end(), referencePositions.begin(), referencePositions.end(),
+            [](const auto &a, const auto &b) { return a.x == b.x && a.y == b.y; });
+        printf("%10zu %15.2f %9.2fx %15s\n", numThreads, elapsed, reference / elapsed, isSame ? "yes" : "NO");
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Measures how MotionComponentManager scales with the number of worker threads, stepping 100k moving entities. The
+// positions reached after all ticks are checked against the single-threaded run: chunking is deterministic, so they must
+// be exactly the same.
+// Usage: parallel_motion_benchmark [max_threads], max_threads defaults to the number of hardware threads.
+#include <simple-2d/core.h>
+#include <simple-2d/entity.h>
+#include <simple-2d/components/motion.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define NUM_ENTITIES 100000
+#define NUM_TICKS 200
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double stepMotion(size_t numThreads, std::vector<simple_2d::XYCoordinate<float>> &finalPositions) {
+    auto &engine = simple_2d::Engine::GetInstance();
+    engine.GetWorkerPool().SetNumThreads(numThreads);
+    auto scene = std::make_shared<simple_2d::Scene>(simple_2d::RectangularDimensions<int>{800, 600});
+    engine.SetCurrentScene(scene);
+    std::vector<simple_2d::Entity> entities(NUM_ENTITIES);
+    for (size_t i = 0; i < entities.size(); i++) {
+        entities[i].AddComponent<simple_2d::MotionComponent>();
+        auto motion = entities[i].GetComponent<simple_2d::MotionComponent>();
+        motion->SetVelocity(simple_2d::XYCoordinate<float>(float(i % 7) * 0.1f, 0));
+        motion->SetAcceleration(simple_2d::XYCoordinate<float>(0, 0.2));
+    }
+    auto motionComponentManager = scene->GetComponentManager<simple_2d::MotionComponent>();
+    // Warm up, so that starting the threads is not measured
+    motionComponentManager->Step();
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        motionComponentManager->Step();
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    finalPositions.clear();
+    motionComponentManager->ForEach([&finalPositions](simple_2d::MotionComponent &motion) {
+        finalPositions.push_back(motion.GetPosition());
+    });
+    return elapsed.count() / NUM_TICKS;
+}
+
+int main(int argc, char *argv[]) {
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 1) {
+        maxThreads = std::max(1, atoi(argv[1]));
+    }
+    std::vector<simple_2d::XYCoordinate<float>> referencePositions;
+    std::vector<simple_2d::XYCoordinate<float>> positions;
+    auto reference = stepMotion(1, referencePositions);
+    printf("%10s %15s %10s %15s\n", "threads", "us/tick", "speedup", "deterministic");
+    printf("%10d %15.2f %9.2fx %15s\n", 1, reference, 1.0, "yes");
+    for (size_t numThreads = 2; numThreads <= maxThreads; numThreads *= 2) {
+        auto elapsed = stepMotion(numThreads, positions);
+        auto isSame = std::equal(positions.begin(), positions.end(), referencePositions.begin(), referencePositions.end(),
+            [](const auto &a, const auto &b) { return a.x == b.x && a.y == b.y; });
+        printf("%10zu %15.2f %9.2fx %15s\n", numThreads, elapsed, reference / elapsed, isSame ? "yes" : "NO");
+    }
+    return 0;
+}
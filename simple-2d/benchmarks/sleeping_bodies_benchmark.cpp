@@ -0,0 +1,96 @@
+// Measures the collision step of CollisionBodyComponentManager with bodies at rest, as in a level full of crates: stacks
+// of boxes falling with DownwardGravity onto static floors until they rest. The same level is stepped with sleeping
+// allowed and disallowed, and the collision step is timed once the boxes have settled, along with the number of sleeping
+// bodies at the end.
+//
+// Usage: sleeping_bodies_benchmark [num_bodies]
+#include <simple-2d/core.h>
+#include <simple-2d/entity.h>
+#include <simple-2d/components/motion.h>
+#include <simple-2d/components/collision_body.h>
+#include <simple-2d/components/downward_gravity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// Enough for the boxes to fall, settle and go to sleep
+#define NUM_SETTLE_TICKS 200
+#define NUM_TICKS 100
+#define BOX_SIZE 16
+#define STACK_HEIGHT 4
+// Stacks standing side by side on each floor
+#define STACKS_PER_FLOOR 32
+#define FLOOR_THICKNESS 16
+// Space above each floor, enough for a stack and the fall
+#define FLOOR_SPACING (STACK_HEIGHT * BOX_SIZE * 2)
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double stepCollisions(bool isSleepingAllowed, size_t numBodies, size_t &numSleepingBodies) {
+    auto &engine = simple_2d::Engine::GetInstance();
+    auto boxesPerFloor = size_t(STACKS_PER_FLOOR * STACK_HEIGHT);
+    auto numFloors = (numBodies + boxesPerFloor - 1) / boxesPerFloor;
+    auto levelWidth = STACKS_PER_FLOOR * BOX_SIZE * 2;
+    auto levelHeight = int(numFloors * (FLOOR_SPACING + FLOOR_THICKNESS));
+    auto scene = std::make_shared<simple_2d::Scene>(simple_2d::RectangularDimensions<int>{levelWidth, levelHeight});
+    engine.SetCurrentScene(scene);
+    std::vector<simple_2d::Entity> floors(numFloors);
+    for (size_t i = 0; i < floors.size(); i++) {
+        floors[i].AddComponent<simple_2d::MotionComponent>();
+        floors[i].AddComponent<simple_2d::CollisionBodyComponent>();
+        floors[i].GetComponent<simple_2d::MotionComponent>()->SetPosition(simple_2d::XYCoordinate<float>(0, float((i + 1) * FLOOR_SPACING + i * FLOOR_THICKNESS)));
+        auto collisionBody = floors[i].GetComponent<simple_2d::CollisionBodyComponent>();
+        collisionBody->SetSize(simple_2d::RectangularDimensions<float>(float(levelWidth), FLOOR_THICKNESS));
+        collisionBody->SetBodyType(simple_2d::CollisionBodyComponent::Static);
+    }
+    std::vector<simple_2d::Entity> boxes(numBodies);
+    for (size_t i = 0; i < boxes.size(); i++) {
+        auto floor = i / boxesPerFloor;
+        auto stack = (i % boxesPerFloor) / STACK_HEIGHT;
+        auto level = i % STACK_HEIGHT;
+        boxes[i].AddComponent<simple_2d::MotionComponent>();
+        boxes[i].AddComponent<simple_2d::CollisionBodyComponent>();
+        boxes[i].AddComponent<simple_2d::DownwardGravity>();
+        // Boxes of a stack start a few pixels apart, so they land on each other
+        auto floorTop = float((floor + 1) * FLOOR_SPACING + floor * FLOOR_THICKNESS);
+        boxes[i].GetComponent<simple_2d::MotionComponent>()->SetPosition(simple_2d::XYCoordinate<float>(float(stack * BOX_SIZE * 2), floorTop - (level + 1) * (BOX_SIZE + 4)));
+        auto collisionBody = boxes[i].GetComponent<simple_2d::CollisionBodyComponent>();
+        collisionBody->SetSize(simple_2d::RectangularDimensions<float>(BOX_SIZE, BOX_SIZE));
+        collisionBody->SetSleepingAllowed(isSleepingAllowed);
+    }
+    auto gravityComponentManager = scene->GetComponentManager<simple_2d::DownwardGravity>();
+    auto motionComponentManager = scene->GetComponentManager<simple_2d::MotionComponent>();
+    auto collisionBodyComponentManager = scene->GetComponentManager<simple_2d::CollisionBodyComponent>();
+    for (auto tick = 0; tick < NUM_SETTLE_TICKS; tick++) {
+        gravityComponentManager->Step();
+        collisionBodyComponentManager->Step();
+        motionComponentManager->Step();
+    }
+    double elapsed = 0;
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        gravityComponentManager->Step();
+        auto start = Clock::now();
+        collisionBodyComponentManager->Step();
+        elapsed += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        motionComponentManager->Step();
+    }
+    numSleepingBodies = collisionBodyComponentManager->GetNumSleepingBodies();
+    return elapsed / NUM_TICKS;
+}
+
+int main(int argc, char *argv[]) {
+    size_t numBodies = 10000;
+    if (argc > 1) {
+        numBodies = size_t(std::strtoul(argv[1], nullptr, 10));
+    }
+    size_t numSleepingBodies = 0;
+    printf("%10s %10s %15s %10s\n", "sleeping", "bodies", "us/tick", "asleep");
+    auto awake = stepCollisions(false, numBodies, numSleepingBodies);
+    printf("%10s %10zu %15.2f %10zu\n", "off", numBodies, awake, numSleepingBodies);
+    auto asleep = stepCollisions(true, numBodies, numSleepingBodies);
+    printf("%10s %10zu %15.2f %10zu\n", "on", numBodies, asleep, numSleepingBodies);
+    printf("speedup: %.2fx\n", awake / asleep);
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Measures the spatial queries of CollisionBodyComponentManager on each broadphase backend: a level of bodies 16 to 64
+// pixels wide, each of a few hundred "enemies" looking around it every tick with a raycast of 400 pixels, a region query
+// of 400 x 400 pixels and its 8 nearest bodies. The region query is compared with a scan of every collision body, the
+// only option without the queries.
+//
+// Usage: spatial_query_benchmark [num_bodies] [num_queriers]
+#include <simple-2d/core.h>
+#include <simple-2d/entity.h>
+#include <simple-2d/components/motion.h>
+#include <simple-2d/components/collision_body.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define NUM_TICKS 20
+#define QUERY_RANGE 400
+#define NUM_NEAREST 8
+// About 2 bodies per 128 x 128 pixels
+#define LEVEL_AREA_PER_BODY 8192
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct Backend {
+    const char *name;
+    simple_2d::BroadphaseType type;
+};
+
+static const Backend BACKENDS[] = {
+    {"grid", simple_2d::UNIFORM_GRID_BROADPHASE},
+    {"tree", simple_2d::AABB_TREE_BROADPHASE},
+    {"sap", simple_2d::SWEEP_AND_PRUNE_BROADPHASE},
+    {"hash", simple_2d::SPATIAL_HASH_BROADPHASE},
+};
+
+static double elapsedSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static void runBackend(const Backend &backend, size_t numBodies, size_t numQueriers) {
+    auto &engine = simple_2d::Engine::GetInstance();
+    auto levelSize = int(std::sqrt(double(numBodies) * LEVEL_AREA_PER_BODY));
+    auto scene = std::make_shared<simple_2d::Scene>(simple_2d::RectangularDimensions<int>{levelSize, levelSize});
+    engine.SetCurrentScene(scene);
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(0, float(levelSize - 64));
+    std::uniform_real_distribution<float> size(16, 64);
+    std::uniform_real_distribution<float> velocity(-2, 2);
+    std::uniform_real_distribution<float> angle(0, 6.2831853f);
+    std::vector<simple_2d::Entity> bodies(numBodies);
+    for (size_t i = 0; i < bodies.size(); i++) {
+        bodies[i].AddComponent<simple_2d::MotionComponent>();
+        bodies[i].AddComponent<simple_2d::CollisionBodyComponent>();
+        auto motion = bodies[i].GetComponent<simple_2d::MotionComponent>();
+        motion->SetPosition(simple_2d::XYCoordinate<float>(position(random), position(random)));
+        motion->SetVelocity(simple_2d::XYCoordinate<float>(velocity(random), velocity(random)));
+        bodies[i].GetComponent<simple_2d::CollisionBodyComponent>()->SetSize(simple_2d::RectangularDimensions<float>(size(random), size(random)));
+    }
+    auto motionComponentManager = scene->GetComponentManager<simple_2d::MotionComponent>();
+    auto collisionBodyComponentManager = scene->GetComponentManager<simple_2d::CollisionBodyComponent>();
+    collisionBodyComponentManager->SetBroadphaseType(backend.type);
+    std::vector<simple_2d::EntityId> entities;
+    simple_2d::CollisionBodyComponentManager::RaycastHit hit;
+    double raycastTime = 0;
+    double regionTime = 0;
+    double nearestTime = 0;
+    double scanTime = 0;
+    size_t numRegionBodies = 0;
+    size_t numScanBodies = 0;
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        collisionBodyComponentManager->Step();
+        for (size_t i = 0; i < numQueriers; i++) {
+            auto center = bodies[i].GetComponent<simple_2d::MotionComponent>()->GetPosition();
+            auto direction = angle(random);
+            simple_2d::XYCoordinate<float> end(center.x + QUERY_RANGE * std::cos(direction), center.y + QUERY_RANGE * std::sin(direction));
+            simple_2d::Rectangle<float> region({{center.x - QUERY_RANGE / 2, center.y - QUERY_RANGE / 2}, {center.x + QUERY_RANGE / 2, center.y + QUERY_RANGE / 2}});
+            auto start = Clock::now();
+            collisionBodyComponentManager->Raycast(center, end, hit);
+            raycastTime += elapsedSince(start);
+            start = Clock::now();
+            collisionBodyComponentManager->QueryRegion(region, entities);
+            regionTime += elapsedSince(start);
+            numRegionBodies += entities.size();
+            start = Clock::now();
+            collisionBodyComponentManager->QueryNearest(center, NUM_NEAREST, entities);
+            nearestTime += elapsedSince(start);
+            start = Clock::now();
+            entities.clear();
+            collisionBodyComponentManager->ForEach([&entities, &region](simple_2d::CollisionBodyComponent &collisionBody) {
+                auto [error, box] = collisionBody.GetCollisionBoxNextTick();
+                if (error == simple_2d::Error::OK && box.top_left.x <= region.bottom_right.x && region.top_left.x <= box.bottom_right.x &&
+                    box.top_left.y <= region.bottom_right.y && region.top_left.y <= box.bottom_right.y) {
+                    entities.push_back(collisionBody.GetEntityId());
+                }
+            });
+            scanTime += elapsedSince(start);
+            numScanBodies += entities.size();
+        }
+        motionComponentManager->Step();
+    }
+    auto numQueries = double(NUM_TICKS * numQueriers);
+    printf("%8s %10zu %12.2f %12.2f %12.2f %12.2f %10.2f %10.2f\n", backend.name, numBodies, raycastTime / numQueries, regionTime / numQueries,
+           nearestTime / numQueries, scanTime / numQueries, numRegionBodies / numQueries, numScanBodies / numQueries);
+}
+
+int main(int argc, char *argv[]) {
+    size_t numBodies = 10000;
+    if (argc > 1) {
+        numBodies = size_t(std::strtoul(argv[1], nullptr, 10));
+    }
+    size_t numQueriers = 500;
+    if (argc > 2) {
+        numQueriers = size_t(std::strtoul(argv[2], nullptr, 10));
+    }
+    // Each querier is one of the bodies
+    numQueriers = std::min(numBodies, numQueriers);
+    printf("Microseconds per query, %zu queriers over %d ticks\n", numQueriers, NUM_TICKS);
+    printf("%8s %10s %12s %12s %12s %12s %10s %10s\n", "backend", "bodies", "raycast", "region", "nearest", "scan", "found", "scanned");
+    for (auto &backend : BACKENDS) {
+        runBackend(backend, numBodies, numQueriers);
+    }
+    return 0;
+}
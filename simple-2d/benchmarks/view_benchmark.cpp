@@ -0,0 +1,73 @@
+// Measures joined iteration over DownwardGravity and MotionComponent, which is what DownwardGravityComponentManager does
+// every tick. Every entity has a motion component and every other entity also has gravity.
+// "lookup" walks the gravity components and fetches each entity's motion component the way systems used to: through the
+// engine singleton, a shared_ptr copy of the type-erased manager, a virtual GetComponent and a cast. "view" uses
+// Scene::View, which walks the smaller storage and probes the other one directly.
+#include <simple-2d/core.h>
+#include <simple-2d/entity.h>
+#include <simple-2d/components/downward_gravity.h>
+#include <simple-2d/components/motion.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#define NUM_TICKS 100
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static std::shared_ptr<simple_2d::Scene> createScene(size_t numEntities, std::vector<simple_2d::Entity> &entities) {
+    auto &engine = simple_2d::Engine::GetInstance();
+    auto scene = std::make_shared<simple_2d::Scene>(simple_2d::RectangularDimensions<int>{800, 600});
+    engine.SetCurrentScene(scene);
+    // Entities take their ids from the current scene, so they must be created after it is set
+    entities.resize(numEntities);
+    for (size_t i = 0; i < entities.size(); i++) {
+        entities[i].AddComponent<simple_2d::MotionComponent>();
+        if (i % 2 == 0) {
+            entities[i].AddComponent<simple_2d::DownwardGravity>();
+        }
+    }
+    return scene;
+}
+
+static double stepLookup(size_t numEntities) {
+    std::vector<simple_2d::Entity> entities;
+    auto scene = createScene(numEntities, entities);
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        scene->GetComponentManager<simple_2d::DownwardGravity>()->ForEach([](simple_2d::DownwardGravity &downwardGravity) {
+            auto motionComponentManager = simple_2d::Engine::GetInstance().GetComponentManager(simple_2d::ComponentType::MOTION);
+            auto component = motionComponentManager->GetComponent(downwardGravity.GetEntityId());
+            if (component != nullptr) {
+                downwardGravity.Step(*static_cast<simple_2d::MotionComponent *>(component));
+            }
+        });
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    return elapsed.count() / NUM_TICKS;
+}
+
+static double stepView(size_t numEntities) {
+    std::vector<simple_2d::Entity> entities;
+    auto scene = createScene(numEntities, entities);
+    auto start = Clock::now();
+    for (auto tick = 0; tick < NUM_TICKS; tick++) {
+        scene->View<simple_2d::DownwardGravity, simple_2d::MotionComponent>().ForEach(
+            [](simple_2d::EntityId, simple_2d::DownwardGravity &downwardGravity, simple_2d::MotionComponent &motion) {
+                downwardGravity.Step(motion);
+            });
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    return elapsed.count() / NUM_TICKS;
+}
+
+int main() {
+    printf("%10s %20s %20s %10s\n", "entities", "lookup (us/tick)", "view (us/tick)", "speedup");
+    for (size_t numEntities : {1000, 10000, 100000, 1000000}) {
+        auto lookup = stepLookup(numEntities);
+        auto view = stepView(numEntities);
+        printf("%10zu %20.2f %20.2f %9.2fx\n", numEntities, lookup, view, lookup / view);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef SIMPLE_2D_COLLISION_AABB_BUFFER_H
+#define SIMPLE_2D_COLLISION_AABB_BUFFER_H
+#include <simple-2d/geometry.h>
+#include <cstddef>
+#include <vector>
+
+namespace simple_2d {
+    /**
+     * @struct AabbBuffer
+     * @brief Axis-aligned boxes stored as one array per coordinate (structure of arrays).
+     *
+     * Loops testing many boxes against one only touch the coordinates they compare, and the arrays keep their capacity
+     * when cleared, so refilling the buffer every tick allocates nothing once it has grown.
+     */
+    struct AabbBuffer {
+        std::vector<float> minX;
+        std::vector<float> minY;
+        std::vector<float> maxX;
+        std::vector<float> maxY;
+
+        size_t Size() const {
+            return minX.size();
+        }
+
+        void Clear() {
+            minX.clear();
+            minY.clear();
+            maxX.clear();
+            maxY.clear();
+        }
+
+        // Keeps the first size boxes when shrinking
+        void Resize(size_t size) {
+            minX.resize(size);
+            minY.resize(size);
+            maxX.resize(size);
+            maxY.resize(size);
+        }
+
+        void PushBack(const Rectangle<float> &box) {
+            minX.push_back(box.top_left.x);
+            minY.push_back(box.top_left.y);
+            maxX.push_back(box.bottom_right.x);
+            maxY.push_back(box.bottom_right.y);
+        }
+
+        void Set(size_t index, const Rectangle<float> &box) {
+            minX[index] = box.top_left.x;
+            minY[index] = box.top_left.y;
+            maxX[index] = box.bottom_right.x;
+            maxY[index] = box.bottom_right.y;
+        }
+
+        Rectangle<float> Get(size_t index) const {
+            return Rectangle<float>({{minX[index], minY[index]}, {maxX[index], maxY[index]}});
+        }
+
+        // Same test as AreRectanglesOverlap: boxes touching by an edge overlap.
+        bool Overlap(size_t index1, size_t index2) const {
+            return minX[index1] <= maxX[index2] && minX[index2] <= maxX[index1] &&
+                   minY[index1] <= maxY[index2] && minY[index2] <= maxY[index1];
+        }
+    };
+}
+
+#endif // SIMPLE_2D_COLLISION_AABB_BUFFER_H
@@ -0,0 +1,90 @@
+#ifndef SIMPLE_2D_COLLISION_AABB_TREE_H
+#define SIMPLE_2D_COLLISION_AABB_TREE_H
+#include <simple-2d/collision/broadphase.h>
+#include <cstdint>
+#include <vector>
+
+namespace simple_2d {
+    /**
+     * @class AabbTree
+     * @brief Broadphase storing the bodies in a dynamic bounding volume tree: each leaf is a body, each inner node the
+     * box enclosing its 2 children.
+     *
+     * Leaves are kept across updates and matched to bodies by entity id. A leaf stores the box of its body fattened by
+     * FAT_MARGIN on every side, and is only moved when the body leaves it, so bodies moving slowly cost nothing to update.
+     * A moved leaf is removed and inserted again next to the sibling which grows the tree the least, then the nodes
+     * above it are refitted and rotated to keep the tree balanced.
+     *
+     * Nothing depends on the scene dimensions, so bodies may be anywhere and of any size. Nodes are stored in a single
+     * array and recycled through a free list. Queries need the boxes of the nodes to reach the leaves, so filters are
+     * tested on the leaves found.
+     */
+    class AabbTree : public Broadphase {
+    public:
+        // Extra space around the box of each body in its leaf, in pixels
+        static constexpr float FAT_MARGIN = 8.0f;
+
+        AabbTree() = default;
+        void Update(const std::vector<EntityId> &entities, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) override;
+        // Pairs are reported when the fattened boxes of both bodies overlap, ordered by body indices.
+        void FindPairs(std::vector<CollisionPair> &pairs) override;
+        // Pairs are reported when the box of the body of [begin, end) overlaps the fattened box of the other one.
+        void FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) override;
+        // Bodies whose fattened box overlaps the region
+        void QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) override;
+        // Number of edges from the root to the deepest leaf, 0 for a single body and -1 when empty
+        int32_t GetHeight() const;
+    private:
+        typedef int32_t NodeId;
+        static constexpr NodeId NULL_NODE = -1;
+
+        struct Node {
+            float minX;
+            float minY;
+            float maxX;
+            float maxY;
+            // Next free node when the node is in the free list
+            NodeId parent = NULL_NODE;
+            NodeId child1 = NULL_NODE;
+            NodeId child2 = NULL_NODE;
+            // 0 for leaves
+            int32_t height = 0;
+            // Leaves only
+            EntityId entityId = INVALID_ENTITY_ID;
+            CollisionBodyIndex body = 0;
+            uint32_t lastUpdate = 0;
+
+            bool IsLeaf() const {
+                return child1 == NULL_NODE;
+            }
+        };
+
+        NodeId AllocateNode();
+        void FreeNode(NodeId node);
+        void InsertLeaf(NodeId leaf);
+        void RemoveLeaf(NodeId leaf);
+        // Node next to which inserting the leaf grows the tree the least
+        NodeId FindBestSibling(NodeId leaf) const;
+        // Refits the nodes from node to the root, rotating each of them first
+        void RefitAncestors(NodeId node);
+        // Swaps a child of node with a grandchild on the other side if that shrinks the tree
+        void Rotate(NodeId node);
+        void SetFattenedBox(Node &leaf, const AabbBuffer &boxes, CollisionBodyIndex body);
+        // Calls fn(leaf) for every leaf whose box overlaps the given box
+        template<typename Function>
+        void Query(float minX, float minY, float maxX, float maxY, Function &&fn);
+
+        std::vector<Node> mNodes;
+        NodeId mRoot = NULL_NODE;
+        NodeId mFreeList = NULL_NODE;
+        // Leaf of each entity, indexed by entity index. The leaf belongs to the entity only if their ids match.
+        std::vector<NodeId> mEntityLeaves;
+        // Every leaf in the tree, to find the ones whose body is gone
+        std::vector<NodeId> mLeaves;
+        std::vector<NodeId> mStack;
+        std::vector<NodeId> mQueryLeaves;
+        uint32_t mUpdate = 0;
+    };
+}
+
+#endif // SIMPLE_2D_COLLISION_AABB_TREE_H
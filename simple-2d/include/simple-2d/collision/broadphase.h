@@ -0,0 +1,105 @@
+#ifndef SIMPLE_2D_COLLISION_BROADPHASE_H
+#define SIMPLE_2D_COLLISION_BROADPHASE_H
+#include <simple-2d/collision/aabb_buffer.h>
+#include <simple-2d/generic_types.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace simple_2d {
+    // Index of a body in the arrays handed to a broadphase. Bodies are numbered from 0 every time the broadphase is built.
+    typedef uint32_t CollisionBodyIndex;
+
+    struct CollisionPair {
+        // first < second
+        CollisionBodyIndex first;
+        CollisionBodyIndex second;
+    };
+
+    /**
+     * @struct CollisionFilter
+     * @brief Collision layers of a body: the categories it belongs to and the categories it collides with, one per bit.
+     *
+     * 2 bodies collide only if each one belongs to a category the other collides with, e.g. enemies which do not collide
+     * with each other belong to an enemy category left out of their mask. Broadphases test this before reading any box,
+     * so the pairs it rejects cost one AND per body instead of a box test and a narrowphase check.
+     */
+    struct CollisionFilter {
+        uint32_t categoryBits = 1;
+        uint32_t maskBits = 0xffffffff;
+
+        bool ShouldCollide(const CollisionFilter &other) const {
+            return (categoryBits & other.maskBits) != 0 && (other.categoryBits & maskBits) != 0;
+        }
+    };
+
+    // Cell based broadphases keep the bodies covering more cells than this out of the cells, in a list of large bodies
+    // which each body is tested against once. Otherwise a body like the ground would be added to, and paired from, every
+    // cell it covers.
+    constexpr size_t LARGE_BODY_NUM_CELLS = 16;
+
+    enum BroadphaseType {
+        // Square cells over the scene dimensions. Fastest for bodies of similar sizes spread over a bounded scene.
+        UNIFORM_GRID_BROADPHASE,
+        // Dynamic bounding volume tree. No bounds and no cell size, so it suits large scenes and bodies of any size.
+        AABB_TREE_BROADPHASE,
+        // Bodies sorted along X, kept sorted between ticks. Suits levels spread horizontally where bodies move little.
+        SWEEP_AND_PRUNE_BROADPHASE,
+        // Cells without bounds hashed into a table, with a cell size tuned from the bodies. Suits unbounded scenes of
+        // bodies of similar sizes.
+        SPATIAL_HASH_BROADPHASE,
+    };
+
+    /**
+     * @class Broadphase
+     * @brief Finds the pairs of bodies which may overlap, so that only those are checked by the narrowphase.
+     *
+     * A broadphase may report pairs which do not overlap, but never misses a pair whose boxes overlap. The pairs and
+     * their order only depend on the updates made so far, so the collision step stays deterministic.
+     */
+    class Broadphase {
+    public:
+        virtual ~Broadphase() = default;
+        /**
+         * @brief Sets the bodies to the boxes [begin, end) of the buffer. Bodies keep their index in the buffer.
+         *
+         * entities[i] identifies body i across updates, so that a backend keeping state between ticks only has to update
+         * the bodies which moved.
+         */
+        virtual void Update(const std::vector<EntityId> &entities, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) = 0;
+        // Appends every pair of bodies of the last update which may overlap to pairs, once.
+        virtual void FindPairs(std::vector<CollisionPair> &pairs) = 0;
+        /**
+         * @brief Appends every pair of a body of the last update and a body of boxes [begin, end) which may overlap, once.
+         * The bodies [begin, end) are not added, so the broadphase can stay as updated while they change every tick.
+         *
+         * Pairs are grouped by the body of [begin, end), in increasing order. The body of the last update is the first of
+         * the pair, so it must have a smaller index than the others.
+         */
+        virtual void FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) = 0;
+        /**
+         * @brief Appends every body of the last update whose box may overlap the region to bodies, once, for spatial
+         * queries. Filters are not applied, and the order depends on the backend.
+         */
+        virtual void QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) = 0;
+        /**
+         * @brief Filters of the bodies, indexed like the boxes. Pairs whose filters reject each other are not reported.
+         *
+         * The vector is read by every later FindPairs and FindPairsWith, so it must outlive them and hold the filters of
+         * the bodies they see. nullptr, the default, reports every pair.
+         */
+        void SetFilters(const std::vector<CollisionFilter> *filters);
+    protected:
+        // Whether the filters of the 2 bodies let them collide. Called before their boxes are read.
+        bool ShouldCollide(CollisionBodyIndex body1, CollisionBodyIndex body2) const {
+            return mFilters == nullptr || (*mFilters)[body1].ShouldCollide((*mFilters)[body2]);
+        }
+
+        const std::vector<CollisionFilter> *mFilters = nullptr;
+    };
+
+    // Creates a broadphase of the given type for a scene of the given dimensions. Backends without bounds ignore them.
+    std::unique_ptr<Broadphase> CreateBroadphase(BroadphaseType type, RectangularDimensions<int> sceneDimensions, uint32_t cellSize);
+}
+
+#endif // SIMPLE_2D_COLLISION_BROADPHASE_H
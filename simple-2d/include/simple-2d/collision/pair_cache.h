@@ -0,0 +1,154 @@
+#ifndef SIMPLE_2D_COLLISION_PAIR_CACHE_H
+#define SIMPLE_2D_COLLISION_PAIR_CACHE_H
+#include <simple-2d/generic_types.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace simple_2d {
+    // Identifies an unordered pair of entities: the smaller id in the high bits, the larger in the low bits.
+    typedef uint64_t CollisionPairKey;
+
+    inline CollisionPairKey MakeCollisionPairKey(EntityId entityId1, EntityId entityId2) {
+        if (entityId1 > entityId2) {
+            std::swap(entityId1, entityId2);
+        }
+        return (CollisionPairKey(entityId1) << 32) | entityId2;
+    }
+
+    /**
+     * @class CollisionPairCache
+     * @brief Flat hash table from a pair of entities to what is known about their contact, kept across ticks.
+     *
+     * Open addressing with linear probing in a single array, so lookups touch one or two cache lines and inserting a pair
+     * that is already known allocates nothing. Erasing shifts the following entries back instead of leaving tombstones, so
+     * lookups do not slow down as contacts come and go.
+     *
+     * @tparam Value Data stored per pair. Must be default constructible.
+     */
+    template<typename Value>
+    class CollisionPairCache {
+    public:
+        struct Entry {
+            CollisionPairKey key = EMPTY_KEY;
+            Value value;
+        };
+
+        // Returns nullptr if the pair is not in the cache.
+        Value* Find(CollisionPairKey key) {
+            if (mSize == 0) {
+                return nullptr;
+            }
+            for (auto slot = GetHomeSlot(key);; slot = (slot + 1) & mMask) {
+                if (mEntries[slot].key == key) {
+                    return &mEntries[slot].value;
+                }
+                if (mEntries[slot].key == EMPTY_KEY) {
+                    return nullptr;
+                }
+            }
+        }
+
+        // Returns the value of the pair, default constructed if the pair was not in the cache. isInserted tells which.
+        Value& FindOrInsert(CollisionPairKey key, bool &isInserted) {
+            // Keep the table at most half full, so probe sequences stay short
+            if ((mSize + 1) * 2 > mEntries.size()) {
+                Grow();
+            }
+            auto slot = GetHomeSlot(key);
+            while (mEntries[slot].key != EMPTY_KEY) {
+                if (mEntries[slot].key == key) {
+                    isInserted = false;
+                    return mEntries[slot].value;
+                }
+                slot = (slot + 1) & mMask;
+            }
+            mEntries[slot].key = key;
+            mEntries[slot].value = Value();
+            mSize++;
+            isInserted = true;
+            return mEntries[slot].value;
+        }
+
+        bool Erase(CollisionPairKey key) {
+            if (mSize == 0) {
+                return false;
+            }
+            auto slot = GetHomeSlot(key);
+            while (mEntries[slot].key != key) {
+                if (mEntries[slot].key == EMPTY_KEY) {
+                    return false;
+                }
+                slot = (slot + 1) & mMask;
+            }
+            // Move back every following entry whose home slot is not between the hole and itself, so that no probe
+            // sequence crosses an empty slot before reaching its entry
+            auto hole = slot;
+            for (auto next = (hole + 1) & mMask; mEntries[next].key != EMPTY_KEY; next = (next + 1) & mMask) {
+                auto home = GetHomeSlot(mEntries[next].key);
+                if (((next - home) & mMask) >= ((next - hole) & mMask)) {
+                    mEntries[hole] = std::move(mEntries[next]);
+                    hole = next;
+                }
+            }
+            mEntries[hole].key = EMPTY_KEY;
+            mSize--;
+            return true;
+        }
+
+        // Calls fn(key, value) for every pair, in table order. fn must not insert or erase.
+        template<typename Function>
+        void ForEach(Function &&fn) {
+            for (auto &entry : mEntries) {
+                if (entry.key != EMPTY_KEY) {
+                    fn(entry.key, entry.value);
+                }
+            }
+        }
+
+        size_t Size() const {
+            return mSize;
+        }
+
+        void Clear() {
+            for (auto &entry : mEntries) {
+                entry.key = EMPTY_KEY;
+            }
+            mSize = 0;
+        }
+    private:
+        // An entity is never paired with itself, so this key is never used by a real pair
+        static constexpr CollisionPairKey EMPTY_KEY = ~CollisionPairKey(0);
+        static constexpr size_t INITIAL_CAPACITY = 64;
+
+        size_t GetHomeSlot(CollisionPairKey key) const {
+            // Finalizer of splitmix64: entity ids are small consecutive numbers, which would all land in a few slots
+            key ^= key >> 30;
+            key *= 0xbf58476d1ce4e5b9ull;
+            key ^= key >> 27;
+            key *= 0x94d049bb133111ebull;
+            key ^= key >> 31;
+            return size_t(key) & mMask;
+        }
+
+        void Grow() {
+            std::vector<Entry> entries(mEntries.empty() ? INITIAL_CAPACITY : mEntries.size() * 2);
+            std::swap(entries, mEntries);
+            mMask = mEntries.size() - 1;
+            mSize = 0;
+            for (auto &entry : entries) {
+                if (entry.key != EMPTY_KEY) {
+                    bool isInserted;
+                    FindOrInsert(entry.key, isInserted) = std::move(entry.value);
+                }
+            }
+        }
+
+        std::vector<Entry> mEntries;
+        size_t mMask = 0;
+        size_t mSize = 0;
+    };
+}
+
+#endif // SIMPLE_2D_COLLISION_PAIR_CACHE_H
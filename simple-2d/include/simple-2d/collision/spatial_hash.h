@@ -0,0 +1,102 @@
+#ifndef SIMPLE_2D_COLLISION_SPATIAL_HASH_H
+#define SIMPLE_2D_COLLISION_SPATIAL_HASH_H
+#include <simple-2d/collision/broadphase.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simple_2d {
+    /**
+     * @struct SpatialHashStats
+     * @brief Occupancy of a spatial hash after its last update, to check the cell size chosen on a real level.
+     */
+    struct SpatialHashStats {
+        float cellSize = 0;
+        size_t numBodies = 0;
+        // Cells covered by at least one body
+        size_t numOccupiedCells = 0;
+        // Sum over the bodies of the number of cells they cover
+        size_t numCellEntries = 0;
+        uint32_t maxBodiesPerCell = 0;
+        // numCellEntries / numOccupiedCells. Close to 1 means cells are too small, large means they are too big.
+        float averageBodiesPerCell = 0;
+        // numCellEntries over the bodies which are not large. Well above 4 means cells are small compared to the bodies.
+        float averageCellsPerBody = 0;
+        // Bodies covering more than LARGE_BODY_NUM_CELLS cells, kept out of the cells
+        size_t numLargeBodies = 0;
+        size_t numBuckets = 0;
+        // Buckets holding more than one cell, which all lookups of these cells scan
+        size_t numSharedBuckets = 0;
+    };
+
+    /**
+     * @class SpatialHash
+     * @brief Broadphase dividing the plane into square cells without bounds, and pairing the bodies sharing a cell.
+     *
+     * Cells are addressed by signed coordinates, so bodies may be anywhere, and only the occupied ones are stored: cell
+     * coordinates are hashed into a table with at least as many buckets as (body, cell) entries, filled by a
+     * counting sort like UniformGrid. Each entry keeps its cell coordinates, so cells sharing a bucket are told apart.
+     * Bodies covering more than LARGE_BODY_NUM_CELLS cells are kept in a list instead, like in UniformGrid.
+     *
+     * Unless a cell size is set, it is tuned from the bodies: a power of 2 at least as large as most of them, chosen on
+     * the first update and every RETUNE_INTERVAL updates. A power of 2 keeps it from changing for small variations.
+     */
+    class SpatialHash : public Broadphase {
+    public:
+        // Share of the bodies which fit in a single cell in each axis, or in 2 if they straddle a border
+        static constexpr float TUNING_PERCENTILE = 0.9f;
+        static constexpr uint32_t RETUNE_INTERVAL = 64;
+        static constexpr float MIN_CELL_SIZE = 8;
+
+        SpatialHash() = default;
+        // Uses cellSize for every update instead of tuning it. 0 turns tuning back on.
+        void SetCellSize(float cellSize);
+        float GetCellSize() const;
+        void Update(const std::vector<EntityId> &entities, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) override;
+        // A pair is reported in the first cell (row-major) both bodies cover, so the order only depends on the boxes,
+        // their order and the cell size. Pairs with a large body come last, in body order.
+        void FindPairs(std::vector<CollisionPair> &pairs) override;
+        void FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) override;
+        // Bodies sharing a cell with the region. A region covering more cells than there are bodies tests every body.
+        void QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) override;
+        SpatialHashStats GetStats() const;
+    private:
+        struct CellRange {
+            int32_t minX;
+            int32_t minY;
+            int32_t maxX;
+            int32_t maxY;
+        };
+
+        struct CellEntry {
+            int32_t x;
+            int32_t y;
+            CollisionBodyIndex body;
+        };
+
+        // Sets mCellSize from the sizes of the bodies [begin, end)
+        void Tune(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end);
+        int32_t GetCellCoordinate(float coordinate) const;
+        CellRange GetCellRange(const AabbBuffer &boxes, CollisionBodyIndex body) const;
+        CellRange GetCellRange(float minX, float minY, float maxX, float maxY) const;
+        uint32_t GetBucket(int32_t x, int32_t y) const;
+        static size_t GetNumCells(const CellRange &cells);
+        static bool AreCellRangesOverlap(const CellRange &cells1, const CellRange &cells2);
+
+        float mCellSize = MIN_CELL_SIZE;
+        bool mIsTuned = true;
+        uint32_t mNumUpdates = 0;
+        uint32_t mBucketMask = 0;
+        std::vector<uint32_t> mBucketStarts;
+        std::vector<CellEntry> mBucketEntries;
+        // Cells covered by each body. Body i is at i - mFirstBody.
+        std::vector<CellRange> mBodyCells;
+        CollisionBodyIndex mFirstBody = 0;
+        // Bodies covering more than LARGE_BODY_NUM_CELLS cells, in increasing order
+        std::vector<CollisionBodyIndex> mLargeBodies;
+        // Scratch buffer of the tuning
+        std::vector<float> mSizes;
+    };
+}
+
+#endif // SIMPLE_2D_COLLISION_SPATIAL_HASH_H
@@ -0,0 +1,64 @@
+#ifndef SIMPLE_2D_COLLISION_SWEEP_AND_PRUNE_H
+#define SIMPLE_2D_COLLISION_SWEEP_AND_PRUNE_H
+#include <simple-2d/collision/broadphase.h>
+#include <cstdint>
+#include <vector>
+
+namespace simple_2d {
+    /**
+     * @class SweepAndPrune
+     * @brief Broadphase keeping the bodies sorted by their left edge, and pairing each body with the following ones until
+     * their left edge is past its right edge.
+     *
+     * The sorted list is kept between updates and matched to bodies by entity id. Bodies only move a little between
+     * ticks, so the list is nearly sorted and an insertion sort puts it back in order in close to linear time.
+     *
+     * Only the X axis is swept, which suits levels spread horizontally. Bodies stacked vertically at the same X are all
+     * compared with each other. Bodies wider than WIDE_BODY_WIDTH, like the ground, are kept out of the list and tested
+     * against each body once, otherwise every search would have to start that far to the left.
+     */
+    class SweepAndPrune : public Broadphase {
+    public:
+        SweepAndPrune() = default;
+        void Update(const std::vector<EntityId> &entities, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) override;
+        // Pairs follow the sorted list, which only depends on the boxes and body indices.
+        void FindPairs(std::vector<CollisionPair> &pairs) override;
+        void FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) override;
+        // Bodies overlapping the region, found by a binary search on the left edges like FindPairsWith, then the wide bodies
+        void QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) override;
+        // Number of swaps done by the last update to sort the list, to measure how coherent the motion is
+        size_t GetNumSwaps() const;
+    private:
+        static constexpr uint32_t NULL_ENTRY = UINT32_MAX;
+        static constexpr float WIDE_BODY_WIDTH = 256;
+
+        struct Entry {
+            float minX;
+            float maxX;
+            float minY;
+            float maxY;
+            EntityId entityId;
+            CollisionBodyIndex body;
+            uint32_t lastUpdate;
+        };
+
+        // Sorted by minX, then by body so that the order does not depend on when the bodies were added
+        static bool IsBefore(const Entry &entry1, const Entry &entry2);
+        // Whether the boxes of the entry and the body overlap, once both are known to collide
+        static bool IsOverlapping(const Entry &entry, const AabbBuffer &boxes, CollisionBodyIndex body);
+
+        // Sorted with IsBefore, without the wide bodies
+        std::vector<Entry> mEntries;
+        // Bodies wider than WIDE_BODY_WIDTH, in increasing order. Rebuilt by each update, since there are few of them.
+        std::vector<Entry> mWideEntries;
+        // Entry of each entity, indexed by entity index. The entry belongs to the entity only if it is within the list and
+        // their ids match.
+        std::vector<uint32_t> mEntityEntries;
+        // Widest body of the sorted list, which bounds how far left of a box the bodies overlapping it start
+        float mMaxWidth = 0;
+        size_t mNumSwaps = 0;
+        uint32_t mUpdate = 0;
+    };
+}
+
+#endif // SIMPLE_2D_COLLISION_SWEEP_AND_PRUNE_H
@@ -0,0 +1,87 @@
+#ifndef SIMPLE_2D_COLLISION_UNIFORM_GRID_H
+#define SIMPLE_2D_COLLISION_UNIFORM_GRID_H
+#include <simple-2d/collision/broadphase.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simple_2d {
+    /**
+     * @class UniformGrid
+     * @brief Broadphase dividing the scene into square cells and pairing the bodies sharing a cell.
+     *
+     * The cell -> bodies table is stored as two flat arrays (compressed sparse rows): mCellStarts[c] is the offset of the
+     * first body of cell c in mCellBodies and mCellStarts[c + 1] the offset past its last one. It is filled by a counting
+     * sort over all bodies, so building it is two linear passes and, once the buffers have grown to the size of the
+     * scene, allocates nothing.
+     *
+     * Coordinates outside the scene are clamped to the border cells, so bodies leaving the scene still collide with each
+     * other (they only share more cells than needed). Bodies covering more than LARGE_BODY_NUM_CELLS cells are not binned
+     * but kept in a list, and paired with the bodies whose cells overlap theirs. Nothing is kept between builds, so the
+     * entities given to Update are ignored.
+     */
+    class UniformGrid : public Broadphase {
+    public:
+        typedef uint32_t CellId;
+
+        UniformGrid() = default;
+        // Covers a scene of the given dimensions with cells of cellSize x cellSize. The last row and column are partially
+        // covered if the dimensions are not a multiple of cellSize.
+        void SetBounds(RectangularDimensions<int> sceneDimensions, uint32_t cellSize);
+        // Bins every box. Body i is box i of the buffer.
+        void Build(const AabbBuffer &boxes);
+        // Bins the boxes [begin, end) of the buffer only. Bodies keep their index in the buffer.
+        void Build(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end);
+        // Same as Build(boxes, begin, end)
+        void Update(const std::vector<EntityId> &entities, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) override;
+        /**
+         * @brief Appends every pair of bodies sharing at least one cell to pairs, once.
+         *
+         * A pair is reported in the first cell (row-major) both bodies cover, and pairs of the same cell are ordered by
+         * body index, so the order only depends on the boxes and their order. Pairs with a large body come last, in body
+         * order.
+         */
+        void FindPairs(std::vector<CollisionPair> &pairs) override;
+        /**
+         * @brief Appends every pair of a body of the grid and a body of boxes [begin, end) sharing at least one cell, once.
+         * The bodies [begin, end) are not binned, so the grid can stay as built while they change every tick.
+         *
+         * Pairs are ordered by the body of [begin, end), then by the first cell shared, then by index, followed by the
+         * large bodies of the grid. The body of the grid is the first of the pair, so it must have a smaller index than
+         * the others.
+         */
+        void FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) override;
+        // Bodies sharing a cell with the region. A region covering more cells than there are bodies tests every body.
+        void QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) override;
+        uint32_t GetNumCellsX() const;
+        uint32_t GetNumCellsY() const;
+    private:
+        struct CellRange {
+            uint32_t minX;
+            uint32_t minY;
+            uint32_t maxX;
+            uint32_t maxY;
+        };
+
+        // Cell column or row of a coordinate, clamped to [0, numCells - 1]
+        uint32_t GetCellCoordinate(float coordinate, uint32_t numCells) const;
+        CellRange GetCellRange(const AabbBuffer &boxes, CollisionBodyIndex body) const;
+        CellRange GetCellRange(float minX, float minY, float maxX, float maxY) const;
+        CellId GetCellId(uint32_t x, uint32_t y) const;
+        static size_t GetNumCells(const CellRange &cells);
+        static bool AreCellRangesOverlap(const CellRange &cells1, const CellRange &cells2);
+
+        uint32_t mCellSize = 1;
+        uint32_t mNumCellsX = 1;
+        uint32_t mNumCellsY = 1;
+        std::vector<uint32_t> mCellStarts;
+        std::vector<CollisionBodyIndex> mCellBodies;
+        // Cells covered by each body, to find the first cell shared by a pair. Body i is at i - mFirstBody.
+        std::vector<CellRange> mBodyCells;
+        CollisionBodyIndex mFirstBody = 0;
+        // Bodies covering more than LARGE_BODY_NUM_CELLS cells, in increasing order
+        std::vector<CollisionBodyIndex> mLargeBodies;
+    };
+}
+
+#endif // SIMPLE_2D_COLLISION_UNIFORM_GRID_H
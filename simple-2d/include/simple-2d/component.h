@@ -9,9 +9,14 @@
 #include <SDL3/SDL_events.h>
 #include <functional>
 #include "generic_types.h"
+#include "component_storage.h"
+#include "worker_pool.h"
+#include "utils.h"
 #include <string>
 
 namespace simple_2d {
+    class Scene;
+
     enum ComponentType {
         BEGIN_COMPONENT_TYPE,
         ANIMATED_SPITE,
@@ -25,12 +30,47 @@ namespace simple_2d {
         MAX_COMPONENT_TYPES
     };
 
+    // One bit per ComponentType, telling which components an entity has. See Scene::GetComponentMask.
+    typedef uint32_t ComponentMask;
+    static_assert(MAX_COMPONENT_TYPES <= sizeof(ComponentMask) * 8, "ComponentMask is too small for all component types");
+
+    constexpr ComponentMask GetComponentBit(ComponentType componentType) {
+        return ComponentMask(1) << componentType;
+    }
+
+    constexpr ComponentMask ALL_COMPONENTS = ((ComponentMask(1) << MAX_COMPONENT_TYPES) - 1) & ~GetComponentBit(BEGIN_COMPONENT_TYPE);
+
+    // Shared state outside the component storages that a component manager may use while stepping.
+    enum SceneResource : uint32_t {
+        // The renderer of the graphics subsystem. It is not thread safe and must be used from the thread running the scene.
+        RENDER_RESOURCE = 1 << 0,
+    };
+
+    /**
+     * @struct ComponentAccess
+     * @brief What a component manager touches while stepping. The scene runs two managers at the same time only if neither
+     * writes what the other reads or writes, and they share no resource.
+     */
+    struct ComponentAccess {
+        ComponentMask reads = 0;
+        ComponentMask writes = 0;
+        uint32_t resources = 0;
+        // The step runs user callbacks (scripts, collision callbacks), which may touch any component, create and delete
+        // entities. Such a manager never runs alongside another one.
+        bool isExclusive = false;
+
+        bool ConflictsWith(const ComponentAccess &other) const {
+            return isExclusive || other.isExclusive || (writes & (other.reads | other.writes)) || (other.writes & reads) ||
+                   (resources & other.resources);
+        }
+    };
+
+    // Components have no virtual functions. Each manager knows the concrete type it stores and calls that type's Step()
+    // directly, so the per-component update can be inlined into the manager's loop.
     class Component {
     public:
         void SetEntityId(EntityId id);
         EntityId GetEntityId() const;
-        virtual Error Step() = 0;
-        static std::shared_ptr<Component> CreateComponent(ComponentType componentType, EntityId entityId);
     protected:
         // This field is used by component itself to locate other components with same entity id. For example, a game object
         // that has sprite component might want to know motion component of itself to know where to draw the sprite.
@@ -48,22 +88,157 @@ namespace simple_2d {
     class ComponentManager {
     public:
         ComponentManager();
-        ~ComponentManager();
+        virtual ~ComponentManager();
         void SetName(std::string name);
         std::string GetName();
-        void RegisterNewEntity(EntityId id, std::shared_ptr<Component> component);
-        std::shared_ptr<Component> GetComponent(EntityId id) const;
+        // Creates the component for the entity inside this manager's storage. The returned pointer is owned by the manager
+        // and stays valid until the component is removed.
+        virtual Component* AddComponent(EntityId id) = 0;
+        // Returns nullptr if the entity has no component in this manager. A miss is not an error: callers often probe whether
+        // an entity has a component at all.
+        virtual Component* GetComponent(EntityId id) const = 0;
+        virtual bool HasComponent(EntityId id) const = 0;
         // This function is simply a wrapper for DoStep. Do logging things primarily
         void Step();
         void RemoveEntity(EntityId id);
+        // Removing a component moves another component into its slot. If this is called while the manager is stepping (e.g.
+        // from a callback), the removal is deferred until the step is over so that every component is still stepped exactly
+        // once and in the same order this tick.
         void RemoveComponentOfEntity(EntityId id);
+        virtual size_t GetNumComponents() const = 0;
+        // Makes the manager allocate its components from the arena (or the heap if null). Removes all the components of the
+        // manager, so the scene calls it before any component is added, and with null when it is destroyed.
+        virtual void SetComponentArena(ComponentArena *arena) = 0;
+        // Declared by each manager in its constructor. Defaults to exclusive, which is always safe.
+        void SetComponentAccess(ComponentAccess componentAccess);
+        const ComponentAccess& GetComponentAccess() const;
+        // Scene owning this manager and the type of the components managed. Set by the scene when it creates its managers.
+        void SetScene(Scene *scene, ComponentType componentType);
+        Scene* GetScene() const;
+        ComponentType GetComponentType() const;
     protected:
         // How component manager process each tick is different. For example, most components only loop through all components
         // and call their Step() method. But some components, like collison body, will have special logic that call each component's
         // Step() method will result in lower performance. So this method is designed to be virtual and can be overridden by subclasses.
         virtual void DoStep() = 0;
-        std::map<EntityId, std::shared_ptr<Component>> mComponents;
+        // Actually removes the component. Returns false if the entity has no component in this manager.
+        virtual bool EraseComponent(EntityId id) = 0;
+        // Pool of the engine, for data-parallel steps.
+        WorkerPool& GetWorkerPool() const;
+        // Keep the scene's component masks up to date. Every path that adds or erases a component must call these.
+        void NotifyComponentAdded(EntityId id);
+        void NotifyComponentRemoved(EntityId id);
         std::string mComponentManagerName;
+        Scene *mScene = nullptr;
+        ComponentType mComponentType = BEGIN_COMPONENT_TYPE;
+        ComponentAccess mComponentAccess = {.isExclusive = true};
+    private:
+        bool mIsStepping = false;
+        std::vector<EntityId> mPendingRemovals;
+    };
+
+    /**
+     * @brief Compile-time mapping from a component class to its ComponentType and its manager class. Every component header
+     * specializes it right after declaring the manager, e.g.
+     *
+     *     template<>
+     *     struct ComponentTraits<MotionComponent> {
+     *         static constexpr ComponentType TYPE = MOTION;
+     *         typedef MotionComponentManager Manager;
+     *     };
+     *
+     * @tparam T The component class.
+     */
+    template<typename T>
+    struct ComponentTraits;
+
+    // Mask with the bits of all the component classes Ts set, e.g. MakeComponentMask<MotionComponent, JsonComponent>().
+    template<typename... Ts>
+    constexpr ComponentMask MakeComponentMask() {
+        return (ComponentMask(0) | ... | GetComponentBit(ComponentTraits<Ts>::TYPE));
+    }
+
+    /**
+     * @class PackedComponentManager
+     * @brief Component manager that keeps its components by value in a PackedComponentStorage.
+     *
+     * Built-in managers derive from this and only implement DoStep, which can iterate mComponents directly as T&. Besides
+     * the type-erased ComponentManager interface, it offers typed access that involves no cast and no virtual call.
+     *
+     * @tparam T The concrete component type managed.
+     * @tparam EntityIndex Entity id to dense index mapping of the storage, see PackedComponentStorage.
+     */
+    template<typename T, typename EntityIndex = SparseEntityIndex>
+    class PackedComponentManager : public ComponentManager {
+    public:
+        Component* AddComponent(EntityId id) override {
+            auto &component = mComponents.Emplace(id);
+            BindComponent(component);
+            NotifyComponentAdded(id);
+            return &component;
+        }
+
+        Component* GetComponent(EntityId id) const override {
+            return mComponents.Find(id);
+        }
+
+        bool HasComponent(EntityId id) const override {
+            return mComponents.Contains(id);
+        }
+
+        size_t GetNumComponents() const override {
+            return mComponents.Size();
+        }
+
+        void SetComponentArena(ComponentArena *arena) override {
+            mComponents.SetArena(arena, mComponentType);
+        }
+
+        typedef PackedComponentStorage<T, EntityIndex> Storage;
+
+        // Read access to the packed storage, used by View for joined iteration.
+        const Storage& GetStorage() const {
+            return mComponents;
+        }
+
+        // Typed lookup. Returns nullptr if the entity has no such component.
+        T* Get(EntityId id) const {
+            return mComponents.Find(id);
+        }
+
+        // Calls fn(T&) for every component, in storage order.
+        template<typename Function>
+        void ForEach(Function &&fn) const {
+            for (auto &component : mComponents) {
+                fn(component);
+            }
+        }
+
+        /**
+         * @brief Calls fn(T&) for every component, spreading chunks of the storage over the engine's worker threads.
+         * fn must only touch the component it is given (and read-only shared data), and must not add or remove components.
+         *
+         * @param chunkSize Components per task, 0 for WorkerPool::DEFAULT_CHUNK_SIZE. Chunks depend only on the number of
+         * components and this size, so each component is processed the same way whatever the number of threads.
+         */
+        template<typename Function>
+        void ParallelForEach(Function &&fn, size_t chunkSize = 0) const {
+            GetWorkerPool().ParallelFor(mComponents.Size(), [this, &fn](size_t begin, size_t end) {
+                for (auto index = begin; index < end; index++) {
+                    fn(mComponents.At(index));
+                }
+            }, {.chunkSize = chunkSize});
+        }
+    protected:
+        // Called once when a component is added, to bind its ComponentRefs to sibling storages.
+        virtual void BindComponent(T &) {
+        }
+
+        bool EraseComponent(EntityId id) override {
+            return mComponents.Erase(id);
+        }
+
+        Storage mComponents;
     };
 }; // simple_2d
 
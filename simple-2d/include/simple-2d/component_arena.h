@@ -0,0 +1,64 @@
+#ifndef SIMPLE_2D_COMPONENT_ARENA_H
+#define SIMPLE_2D_COMPONENT_ARENA_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_2d {
+    /**
+     * @struct ComponentMemoryStats
+     * @brief Memory used by the components of one type, to size pools for production levels.
+     */
+    struct ComponentMemoryStats {
+        // Bytes of constructed components, i.e. number of components times the size of one
+        size_t liveBytes = 0;
+        // Highest liveBytes since the arena was created
+        size_t peakLiveBytes = 0;
+        // Bytes of the pages holding the components, including free slots
+        size_t pageBytes = 0;
+        size_t peakPageBytes = 0;
+    };
+
+    /**
+     * @class ComponentArena
+     * @brief Owns the memory of all component storages of a scene.
+     *
+     * Storages get their pages from large blocks, so a scene with a few thousand components makes a handful of heap
+     * allocations instead of one per component, and tearing the scene down frees the blocks in bulk. Pages given back are
+     * kept on a free list per size and reused before the arena grows.
+     *
+     * Memory is tracked per stats slot (the scene uses the ComponentType). The arena is not thread safe: components are
+     * only added and removed from the thread running the scene.
+     */
+    class ComponentArena {
+    public:
+        // Blocks are at least this large. Bigger pages get a block of their own.
+        static constexpr size_t BLOCK_SIZE = size_t(1) << 20;
+
+        ComponentArena() = default;
+        ComponentArena(const ComponentArena&) = delete;
+        ComponentArena& operator=(const ComponentArena&) = delete;
+        ~ComponentArena() = default;
+        // Page of size bytes aligned to alignment, which must be a power of two not greater than alignof(std::max_align_t).
+        void* AllocatePage(size_t statsSlot, size_t size, size_t alignment);
+        void FreePage(size_t statsSlot, void *page, size_t size);
+        // Called by storages when components are constructed (positive) or destroyed (negative).
+        void TrackLiveBytes(size_t statsSlot, ptrdiff_t bytes);
+        ComponentMemoryStats GetStats(size_t statsSlot) const;
+        // Bytes of all blocks allocated from the heap
+        size_t GetReservedBytes() const;
+    private:
+        ComponentMemoryStats& GetMutableStats(size_t statsSlot);
+
+        std::vector<std::unique_ptr<unsigned char[]>> mBlocks;
+        unsigned char *mCursor = nullptr;
+        size_t mBytesLeftInBlock = 0;
+        size_t mReservedBytes = 0;
+        std::unordered_map<size_t, std::vector<void*>> mFreePages;
+        std::vector<ComponentMemoryStats> mStats;
+    };
+}
+
+#endif // SIMPLE_2D_COMPONENT_ARENA_H
@@ -0,0 +1,344 @@
+#ifndef SIMPLE_2D_COMPONENT_STORAGE_H
+#define SIMPLE_2D_COMPONENT_STORAGE_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "generic_types.h"
+#include "component_arena.h"
+
+namespace simple_2d {
+    /**
+     * @class SparseEntityIndex
+     * @brief Maps entity indices to dense indices with a paged sparse array, i.e. the sparse half of a sparse set.
+     *
+     * Find, Set and Erase are two array accesses each, with no hashing and no allocation once the page exists. Entity
+     * indices are recycled by EntityRegistry, so the array stays as small as the peak number of live entities. The index
+     * ignores generations: PackedComponentStorage checks the full id.
+     */
+    class SparseEntityIndex {
+    public:
+        static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+        uint32_t Find(EntityId id) const {
+            auto entityIndex = GetEntityIndex(id);
+            auto page = entityIndex >> PAGE_SHIFT;
+            if (page >= mPages.size() || mPages[page] == nullptr) {
+                return INVALID_INDEX;
+            }
+            return mPages[page][entityIndex & PAGE_MASK];
+        }
+
+        void Set(EntityId id, uint32_t index) {
+            auto entityIndex = GetEntityIndex(id);
+            auto page = entityIndex >> PAGE_SHIFT;
+            if (page >= mPages.size()) {
+                mPages.resize(page + 1);
+            }
+            if (mPages[page] == nullptr) {
+                mPages[page] = std::make_unique<uint32_t[]>(PAGE_SIZE);
+                std::fill_n(mPages[page].get(), PAGE_SIZE, INVALID_INDEX);
+            }
+            mPages[page][entityIndex & PAGE_MASK] = index;
+        }
+
+        void Erase(EntityId id) {
+            auto entityIndex = GetEntityIndex(id);
+            auto page = entityIndex >> PAGE_SHIFT;
+            if (page < mPages.size() && mPages[page] != nullptr) {
+                mPages[page][entityIndex & PAGE_MASK] = INVALID_INDEX;
+            }
+        }
+
+        void Clear() {
+            mPages.clear();
+        }
+    private:
+        static constexpr size_t PAGE_SHIFT = 12;
+        static constexpr size_t PAGE_SIZE = size_t(1) << PAGE_SHIFT;
+        static constexpr size_t PAGE_MASK = PAGE_SIZE - 1;
+        std::vector<std::unique_ptr<uint32_t[]>> mPages;
+    };
+
+    /**
+     * @class HashedEntityIndex
+     * @brief Maps entity indices to dense indices with a hash map. Uses memory proportional to the number of components
+     * only, which suits component types that very few entities have.
+     */
+    class HashedEntityIndex {
+    public:
+        static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+        uint32_t Find(EntityId id) const {
+            auto it = mIndices.find(GetEntityIndex(id));
+            if (it == mIndices.end()) {
+                return INVALID_INDEX;
+            }
+            return it->second;
+        }
+
+        void Set(EntityId id, uint32_t index) {
+            mIndices[GetEntityIndex(id)] = index;
+        }
+
+        void Erase(EntityId id) {
+            mIndices.erase(GetEntityIndex(id));
+        }
+
+        void Clear() {
+            mIndices.clear();
+        }
+    private:
+        std::unordered_map<uint32_t, uint32_t> mIndices;
+    };
+
+    /**
+     * @class PackedComponentStorage
+     * @brief Stores all components of one type by value in a dense array, plus an index from entity id to array index.
+     *
+     * Stepping a component manager is then a linear walk over memory instead of walking a tree of heap nodes. Components
+     * live in fixed-size pages so that adding a component never moves the ones already stored: a behavior script may spawn
+     * entities while its own manager is stepping. Removing a component moves the last component into the freed slot
+     * (swap-and-pop), so the array never has holes.
+     *
+     * Lookups compare the full entity id, generation included, so a stale id of a deleted entity never finds the component
+     * of the entity that reused its index.
+     *
+     * Pages come from the ComponentArena set with SetArena, usually the scene's, or from the heap if there is none.
+     *
+     * @tparam T The concrete component type. It must be constructible from an EntityId and move constructible.
+     * @tparam EntityIndex How entity ids are mapped to dense indices: SparseEntityIndex (default) or HashedEntityIndex.
+     */
+    template<typename T, typename EntityIndex = SparseEntityIndex>
+    class PackedComponentStorage {
+    public:
+        // Number of components per page. Power of 2 so that locating a component is a shift and a mask.
+        static constexpr size_t PAGE_SHIFT = 8;
+        static constexpr size_t PAGE_SIZE = size_t(1) << PAGE_SHIFT;
+        static constexpr size_t PAGE_MASK = PAGE_SIZE - 1;
+
+        class Iterator {
+        public:
+            Iterator(const PackedComponentStorage *storage, size_t index) : mStorage(storage), mIndex(index) {}
+            T& operator*() const { return mStorage->At(mIndex); }
+            T* operator->() const { return &mStorage->At(mIndex); }
+            Iterator& operator++() { mIndex++; return *this; }
+            bool operator==(const Iterator &other) const { return mIndex == other.mIndex; }
+            bool operator!=(const Iterator &other) const { return mIndex != other.mIndex; }
+        private:
+            const PackedComponentStorage *mStorage;
+            size_t mIndex;
+        };
+
+        PackedComponentStorage() = default;
+        PackedComponentStorage(const PackedComponentStorage&) = delete;
+        PackedComponentStorage& operator=(const PackedComponentStorage&) = delete;
+        ~PackedComponentStorage() {
+            Clear();
+        }
+
+        /**
+         * @brief Makes the storage allocate its pages from the arena and report its memory use under statsSlot. Components
+         * already stored are destroyed first.
+         */
+        void SetArena(ComponentArena *arena, size_t statsSlot) {
+            Clear();
+            mArena = arena;
+            mStatsSlot = statsSlot;
+        }
+
+        /**
+         * @brief Constructs a component for the entity in place. If the entity (or a stale entity with the same index)
+         * already has one, it is replaced.
+         *
+         * @return Reference to the stored component. It stays valid until this component (or the last one) is erased.
+         */
+        template<typename... Args>
+        T& Emplace(EntityId id, Args&&... args) {
+            auto existingIndex = mIndices.Find(id);
+            if (existingIndex != EntityIndex::INVALID_INDEX) {
+                T *slot = &At(existingIndex);
+                slot->~T();
+                mVersion++;
+                mEntities[existingIndex] = id;
+                return *new (slot) T(id, std::forward<Args>(args)...);
+            }
+            auto index = mEntities.size();
+            if ((index >> PAGE_SHIFT) >= mPages.size()) {
+                mPages.push_back(AllocatePage());
+            }
+            T *slot = new (SlotAt(index)) T(id, std::forward<Args>(args)...);
+            TrackLiveComponents(1);
+            mEntities.push_back(id);
+            mIndices.Set(id, uint32_t(index));
+            return *slot;
+        }
+
+        T* Find(EntityId id) const {
+            auto index = FindDenseIndex(id);
+            if (index == EntityIndex::INVALID_INDEX) {
+                return nullptr;
+            }
+            return &At(index);
+        }
+
+        bool Contains(EntityId id) const {
+            return FindDenseIndex(id) != EntityIndex::INVALID_INDEX;
+        }
+
+        /**
+         * @brief Removes the component of the entity by moving the last component into its slot.
+         *
+         * @return False if the entity has no component in this storage.
+         */
+        bool Erase(EntityId id) {
+            auto index = FindDenseIndex(id);
+            if (index == EntityIndex::INVALID_INDEX) {
+                return false;
+            }
+            auto lastIndex = mEntities.size() - 1;
+            mIndices.Erase(id);
+            mVersion++;
+            T *slot = &At(index);
+            slot->~T();
+            if (index != lastIndex) {
+                T *last = &At(lastIndex);
+                new (slot) T(std::move(*last));
+                last->~T();
+                mEntities[index] = mEntities[lastIndex];
+                mIndices.Set(mEntities[index], index);
+            }
+            mEntities.pop_back();
+            TrackLiveComponents(-1);
+            return true;
+        }
+
+        void Clear() {
+            for (size_t i = 0; i < mEntities.size(); i++) {
+                At(i).~T();
+            }
+            TrackLiveComponents(-ptrdiff_t(mEntities.size()));
+            mVersion++;
+            mEntities.clear();
+            mIndices.Clear();
+            for (auto page : mPages) {
+                FreePage(page);
+            }
+            mPages.clear();
+        }
+
+        size_t Size() const {
+            return mEntities.size();
+        }
+
+        T& At(size_t index) const {
+            return *std::launder(reinterpret_cast<T*>(SlotAt(index)));
+        }
+
+        EntityId EntityAt(size_t index) const {
+            return mEntities[index];
+        }
+
+        // Changes whenever a stored component may have moved or been destroyed. Adding a component does not change it,
+        // since components never move when one is added. See ComponentRef.
+        uint32_t GetVersion() const {
+            return mVersion;
+        }
+
+        // Iteration covers the components stored when begin()/end() are taken. Components added during iteration are
+        // not visited. Erasing during iteration reorders components, see ComponentManager::RemoveComponentOfEntity.
+        Iterator begin() const { return Iterator(this, 0); }
+        Iterator end() const { return Iterator(this, mEntities.size()); }
+
+    private:
+        struct Page {
+            alignas(T) unsigned char bytes[sizeof(T) * PAGE_SIZE];
+        };
+
+        uint32_t FindDenseIndex(EntityId id) const {
+            auto index = mIndices.Find(id);
+            if (index == EntityIndex::INVALID_INDEX || mEntities[index] != id) {
+                return EntityIndex::INVALID_INDEX;
+            }
+            return index;
+        }
+
+        void* SlotAt(size_t index) const {
+            return mPages[index >> PAGE_SHIFT]->bytes + sizeof(T) * (index & PAGE_MASK);
+        }
+
+        Page* AllocatePage() {
+            if (mArena == nullptr) {
+                return new Page;
+            }
+            return static_cast<Page *>(mArena->AllocatePage(mStatsSlot, sizeof(Page), alignof(Page)));
+        }
+
+        void FreePage(Page *page) {
+            if (mArena == nullptr) {
+                delete page;
+                return;
+            }
+            mArena->FreePage(mStatsSlot, page, sizeof(Page));
+        }
+
+        void TrackLiveComponents(ptrdiff_t numComponents) {
+            if (mArena != nullptr && numComponents != 0) {
+                mArena->TrackLiveBytes(mStatsSlot, numComponents * ptrdiff_t(sizeof(T)));
+            }
+        }
+
+        // Pages hold raw bytes: components are constructed and destroyed explicitly
+        std::vector<Page*> mPages;
+        ComponentArena *mArena = nullptr;
+        size_t mStatsSlot = 0;
+        uint32_t mVersion = 0;
+        // Entity owning the component at the same dense index.
+        std::vector<EntityId> mEntities;
+        EntityIndex mIndices;
+    };
+
+    /**
+     * @class ComponentRef
+     * @brief Cached reference from a component to a sibling component of the same entity, e.g. from a sprite to the
+     * motion component holding its position.
+     *
+     * Get() returns the cached pointer as long as the sibling's storage version has not changed, which costs one compare.
+     * Otherwise, e.g. after RemoveComponentOfEntity moved components around, it looks the sibling up again. A miss is not
+     * cached, so a sibling added after the reference was bound is found on the next Get().
+     *
+     * Bound once by the component manager when the component is added. Not thread safe: use it from the manager owning
+     * the component.
+     */
+    template<typename T, typename EntityIndex = SparseEntityIndex>
+    class ComponentRef {
+    public:
+        void Bind(const PackedComponentStorage<T, EntityIndex> *storage, EntityId entityId) {
+            mStorage = storage;
+            mEntityId = entityId;
+            mComponent = nullptr;
+        }
+
+        T* Get() const {
+            if (mStorage == nullptr) {
+                return nullptr;
+            }
+            if (mComponent == nullptr || mVersion != mStorage->GetVersion()) {
+                mComponent = mStorage->Find(mEntityId);
+                mVersion = mStorage->GetVersion();
+            }
+            return mComponent;
+        }
+    private:
+        const PackedComponentStorage<T, EntityIndex> *mStorage = nullptr;
+        EntityId mEntityId = INVALID_ENTITY_ID;
+        mutable T *mComponent = nullptr;
+        mutable uint32_t mVersion = 0;
+    };
+}; // simple_2d
+
+#endif // SIMPLE_2D_COMPONENT_STORAGE_H
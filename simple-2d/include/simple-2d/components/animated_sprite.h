@@ -2,18 +2,19 @@
 #define SIMPLE_2D_COMPONENT_ANIMATED_SPRITE_H
 
 #include <simple-2d/component.h>
+#include <simple-2d/components/motion.h>
 #include <simple-2d/graphics.h>
 
 namespace simple_2d {
     typedef uint16_t AnimationId;
 
-    class AnimatedSprite : public Component {
+    class AnimatedSprite : public MotionBoundComponent {
     public:
         AnimatedSprite(EntityId entityId);
         ~AnimatedSprite() = default;
         void AddAnimation(AnimationId animationId, ManagedTexture texture, int frameLengthTicks);
         Error PlayAnimation(AnimationId animationId);
-        Error Step() override;
+        Error Step();
         void SetOffset(XYCoordinate<float> offset);
         XYCoordinate<float> GetOffset() const;
     private:
@@ -35,15 +36,23 @@ namespace simple_2d {
         AnimationTree mAnimationTree;
         Status mStatus;
         XYCoordinate<float> mOffset;
-        Error RenderCurrentFrame() const;
+        Error RenderCurrentFrame(const MotionComponent &motion) const;
         Error UpdateAnimation();
     };
 
-    class AnimatedSpriteComponentManager : public ComponentManager {
+    class AnimatedSpriteComponentManager : public PackedComponentManager<AnimatedSprite> {
     public:
         AnimatedSpriteComponentManager();
         ~AnimatedSpriteComponentManager() = default;
         void DoStep() override;
+    protected:
+        void BindComponent(AnimatedSprite &animatedSprite) override;
+    };
+
+    template<>
+    struct ComponentTraits<AnimatedSprite> {
+        static constexpr ComponentType TYPE = ANIMATED_SPITE;
+        typedef AnimatedSpriteComponentManager Manager;
     };
 }
 #endif // SIMPLE_2D_COMPONENT_ANIMATED_SPRITE_H
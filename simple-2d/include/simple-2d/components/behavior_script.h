@@ -13,19 +13,25 @@ namespace simple_2d {
         void SetOnTickEventCallback(std::function<void(EntityId)> callback);
         void SetOnKeyPressedEventCallback(std::function<void(EntityId, const SDL_Event &)> callback);
         void SetOnKeyReleasedEventCallback(std::function<void(EntityId, const SDL_Event &)> callback);
-        Error Step() override;
+        Error Step();
     private:
         std::function<void(EntityId)> mOnTickCallback;
         std::function<void(EntityId, const SDL_Event &)> mOnKeyPressedCallback;
         std::function<void(EntityId, const SDL_Event &)> mOnKeyReleasedCallback;
     };
 
-    class BehaviorScriptComponentManager : public ComponentManager {
+    class BehaviorScriptComponentManager : public PackedComponentManager<BehaviorScript> {
     public:
         BehaviorScriptComponentManager();
         ~BehaviorScriptComponentManager() = default;
         void DoStep() override;
     };
+
+    template<>
+    struct ComponentTraits<BehaviorScript> {
+        static constexpr ComponentType TYPE = BEHAVIOR_SCRIPT;
+        typedef BehaviorScriptComponentManager Manager;
+    };
 }
 
 #endif // SIMPLE_2D_COMPONENTS_BEHAVIOR_SCRIPT_H
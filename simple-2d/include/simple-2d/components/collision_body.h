@@ -2,12 +2,16 @@
 #define SIMPLE_2D_COMPONENT_COLLISION_BODY_H
 
 #include <simple-2d/component.h>
+#include <simple-2d/components/motion.h>
 #include <simple-2d/graphics.h>
 #include <simple-2d/generic_types.h>
-#include <set>
+#include <simple-2d/collision/broadphase.h>
+#include <simple-2d/collision/pair_cache.h>
 
 namespace simple_2d {
-    class CollisionBodyComponent : public Component {
+    class CollisionBodyComponentManager;
+
+    class CollisionBodyComponent : public MotionBoundComponent {
     public:
         struct CollisionResult {
             bool is_colliding = false;
@@ -22,7 +26,20 @@ namespace simple_2d {
             Cb1RightEdgeCollidingWithCb2LeftEdge,
         };
 
+        enum BodyType {
+            // Never moves: its collision box is read when the static bodies are rebuilt, which only happens when a static
+            // body is added, removed or changed. Static bodies are never checked against each other.
+            Static,
+            // Moved by its motion component but not pushed by collisions, e.g. a moving platform. Kinematic bodies are
+            // never checked against each other or against static bodies.
+            Kinematic,
+            // Moved by its motion component and pushed by collisions
+            Dynamic,
+        };
+
         typedef std::function<void(EntityId, EntityId, CollisionType)> OnCollisionCallback;
+        typedef std::function<void(EntityId, EntityId)> OnCollisionExitCallback;
+        typedef std::function<void(EntityId, EntityId)> OnOverlapCallback;
         CollisionBodyComponent(EntityId entityId);
         ~CollisionBodyComponent() = default;
         void SetEnabled(bool enabled);
@@ -31,33 +48,281 @@ namespace simple_2d {
         RectangularDimensions<float> GetSize() const;
         void SetOffset(XYCoordinate<float> offset);
         XYCoordinate<float> GetOffset() const;
+        // Defaults to Dynamic
+        void SetBodyType(BodyType bodyType);
+        BodyType GetBodyType() const;
+        // Collision layers, see CollisionFilter. Defaults to category 1, colliding with every category.
+        void SetCategoryBits(uint32_t categoryBits);
+        uint32_t GetCategoryBits() const;
+        void SetMaskBits(uint32_t maskBits);
+        uint32_t GetMaskBits() const;
+        CollisionFilter GetCollisionFilter() const;
+        // A sensor only reports overlaps, e.g. a pickup or a kill zone: it neither pushes nor is pushed by the bodies it
+        // overlaps, whatever their types, and skips the classification of the collision. Pairs of 2 sensors are ignored.
+        // Defaults to false.
+        void SetSensor(bool isSensor);
+        bool IsSensor() const;
+        // Whether the body may be put to sleep once at rest, see CollisionBodyComponentManager. Defaults to true.
+        void SetSleepingAllowed(bool isSleepingAllowed);
+        bool IsSleepingAllowed() const;
         std::pair<Error, Rectangle<float>> GetCollisionBox() const;
         std::pair<Error, Rectangle<float>> GetCollisionBoxNextTick() const;
         void SetOnCollisionCallback(OnCollisionCallback callback);
         void NotifyCollision(EntityId otherEntityId, CollisionType collisionType);
-        Error Step() override;
+        // Contact events: enter on the first tick 2 bodies collide, stay on every following tick they are still in contact,
+        // exit on the first tick they are not. The callback set with SetOnCollisionCallback is called on enter and stay.
+        // Like the overlap events, they are queued while the collisions are resolved and delivered once the step is over.
+        void SetOnCollisionEnterCallback(OnCollisionCallback callback);
+        void SetOnCollisionStayCallback(OnCollisionCallback callback);
+        void SetOnCollisionExitCallback(OnCollisionExitCallback callback);
+        void NotifyCollisionEnter(EntityId otherEntityId, CollisionType collisionType);
+        void NotifyCollisionStay(EntityId otherEntityId, CollisionType collisionType);
+        void NotifyCollisionExit(EntityId otherEntityId);
+        // Overlap events of the pairs with a sensor, called on both bodies: enter on the first tick their boxes overlap,
+        // exit on the first tick they do not. They are delivered in one batch once the collisions of the tick are resolved.
+        void SetOnOverlapEnterCallback(OnOverlapCallback callback);
+        void SetOnOverlapExitCallback(OnOverlapCallback callback);
+        void NotifyOverlapEnter(EntityId otherEntityId);
+        void NotifyOverlapExit(EntityId otherEntityId);
+        Error Step();
     private:
+        friend class CollisionBodyComponentManager;
+        // Tells the manager to rebuild its static bodies if this one is static or kinematic, so that the bodies sleeping on
+        // it wake up, and wakes it up if it is sleeping
+        void NotifyStaticBodyChanged();
+
+        CollisionBodyComponentManager *mManager = nullptr;
+        BodyType mBodyType = Dynamic;
+        CollisionFilter mFilter;
+        bool mIsSensor = false;
+        bool mIsSleepingAllowed = true;
         bool mIsEnabled = true;
+        // Consecutive ticks the body has been at rest, and its island while sleeping
+        uint32_t mRestTicks = 0;
+        uint32_t mIslandId = 0;
         RectangularDimensions<float> mSize;
         XYCoordinate<float> mOffset;
         CollisionResult mCollisionResult;
         // The callback will be called when 2 entities collide. First entity is always the entity that register callback
         OnCollisionCallback mOnCollisionCallback;
+        OnCollisionCallback mOnCollisionEnterCallback;
+        OnCollisionCallback mOnCollisionStayCallback;
+        OnCollisionExitCallback mOnCollisionExitCallback;
+        OnOverlapCallback mOnOverlapEnterCallback;
+        OnOverlapCallback mOnOverlapExitCallback;
     };
 
-    class CollisionBodyComponentManager : public ComponentManager {
+    /**
+     * @class CollisionBodyComponentManager
+     * @brief Moves the collision bodies apart and reports their collisions, using a broadphase to find the pairs to check.
+     *
+     * Dynamic bodies whose speed stays under SLEEP_SPEED for SLEEP_TICKS ticks are put to sleep with the bodies they
+     * touch, as an island: the bodies in contact with each other, found with a union-find over the colliding pairs. An
+     * island only sleeps once all its bodies are at rest. Sleeping bodies are skipped by the gravity and the motion step,
+     * and act as static bodies here: they stay in the static broadphase and are not checked against static bodies or each
+     * other, so their contacts are kept without stay events. An island wakes up when a moving body collides with one of its
+     * bodies, when the motion of one of them is set through MotionComponent, when one of them is changed or removed, or
+     * when a static or kinematic body it rests on is changed, removed or, for a kinematic body, moves.
+     */
+    class CollisionBodyComponentManager : public PackedComponentManager<CollisionBodyComponent> {
     public:
-        // The entire scene of the game will be divided into a grid of square cells. Each cell will have a unique id.
-        typedef uint32_t CollisionCellId;
+        struct RaycastHit {
+            EntityId entityId = INVALID_ENTITY_ID;
+            // Where the ray enters the collision box of the body, or its start if it starts inside
+            XYCoordinate<float> point;
+            // Position of the hit along the ray, from 0 at its start to 1 at its end
+            float fraction = 1;
+        };
+
         CollisionBodyComponentManager();
         ~CollisionBodyComponentManager() = default;
         void DoStep() override;
+        // Static bodies are only read when they are rebuilt. Call this after moving a static body through its motion
+        // component. Changes made through CollisionBodyComponent are tracked already.
+        void MarkStaticBodiesDirty();
+        // Defaults to UNIFORM_GRID_BROADPHASE. The grid covers the scene dimensions with cells of CELL_SIZE, prefer the
+        // tree when bodies leave the scene or are much larger than a cell, sweep and prune for long horizontal levels and
+        // the spatial hash for unbounded scenes of bodies of similar sizes.
+        void SetBroadphaseType(BroadphaseType broadphaseType);
+        BroadphaseType GetBroadphaseType() const;
+        // Broadphase of the moving bodies, e.g. to read the statistics of a SpatialHash
+        const Broadphase* GetBroadphase() const;
+        // Events of a tick are delivered in the order they happened: collisions pair by pair, then ended contacts, then
+        // overlaps. Grouping them by receiver calls all the callbacks of an entity in a row instead, entities in increasing
+        // id order. Defaults to false.
+        void SetGroupEventsByReceiver(bool isGroupEventsByReceiver);
+        bool IsGroupEventsByReceiver() const;
+        // Events delivered by the last step, one per receiver: a collision between 2 bodies counts twice
+        size_t GetNumEventsLastStep() const;
+        // Bodies sleeping during the last step
+        size_t GetNumSleepingBodies() const;
+        /**
+         * Spatial queries, e.g. line of sight or the enemies near the player, answered by the broadphases of the last step.
+         * They see the bodies enabled during that step, where its resolution left them: at their collision boxes once the
+         * motion of the tick is applied. Changes made by callbacks and scripts since then are not seen, and the entities
+         * returned may have been removed since.
+         *
+         * Only the bodies with a category in maskBits are returned. Results go into vectors owned by the caller, which are
+         * cleared first, and the scratch buffers are kept between queries, so queries allocate nothing once they have
+         * grown. Queries share these buffers: call them from one thread at a time, e.g. from behavior scripts.
+         */
+        // Closest body crossed by the segment from start to end. Returns false if there is none.
+        bool Raycast(XYCoordinate<float> start, XYCoordinate<float> end, RaycastHit &hit, uint32_t maskBits = 0xffffffff);
+        // Bodies whose collision box overlaps the region, boxes touching by an edge included, in the order of the step
+        void QueryRegion(const Rectangle<float> &region, std::vector<EntityId> &entities, uint32_t maskBits = 0xffffffff);
+        // Up to k bodies closest to the point, nearest first, measured to the closest point of their collision box
+        void QueryNearest(XYCoordinate<float> point, size_t k, std::vector<EntityId> &entities, uint32_t maskBits = 0xffffffff);
+    protected:
+        void BindComponent(CollisionBodyComponent &collisionBodyComponent) override;
     private:
-        // Each cell will have a list of unique entities that are in the cell.
-        std::map<CollisionCellId, std::set<EntityId>> mCollisionCellEntitiesMap;
-        uint32_t mNumCellsX;
-        uint32_t mNumCellsY;
-        CollisionCellId GetCollisionCellId(XYCoordinate<CollisionCellId> cellIdPosition);
+        // Only the pairs reported by the broadphase are checked. Moving (dynamic and kinematic) bodies are updated every
+        // tick, static bodies only when they change.
+        BroadphaseType mBroadphaseType = UNIFORM_GRID_BROADPHASE;
+        std::unique_ptr<Broadphase> mBroadphase;
+        std::unique_ptr<Broadphase> mStaticBroadphase;
+        bool mAreStaticBodiesDirty = true;
+        uint32_t mStaticBodiesStorageVersion = 0;
+        CollisionBodyIndex mNumStaticBodies = 0;
+        // Snapshot of the enabled bodies of this tick, indexed by CollisionBodyIndex: their collision boxes this tick and
+        // next tick are computed once, then read by the broadphase and the narrowphase. Kept between ticks to reuse memory.
+        std::vector<EntityId> mBodyEntities;
+        // Stay valid during the step, since removals of collision bodies are deferred until it is over
+        std::vector<CollisionBodyComponent*> mBodyComponents;
+        std::vector<CollisionBodyComponent::BodyType> mBodyTypes;
+        // Read by the broadphases, which skip the pairs rejected by the filters
+        std::vector<CollisionFilter> mBodyFilters;
+        std::vector<bool> mBodyIsSensor;
+        AabbBuffer mBodyBoxes;
+        AabbBuffer mBodyBoxesNextTick;
+        // Box covering a body this tick and next tick, which is what the broadphase sees: the narrowphase checks the boxes
+        // next tick, so a pair touching only next tick must still be reported.
+        AabbBuffer mBodySweptBoxes;
+        std::vector<CollisionPair> mCandidatePairs;
+        // Outcome of the detect phase for a candidate pair
+        enum PairStatus : uint8_t {
+            // Neither body is pushed by the other, or both are sensors
+            PAIR_SKIPPED,
+            PAIR_SENSOR,
+            PAIR_SEPARATE,
+            PAIR_COLLIDING,
+        };
+        struct DetectedPair {
+            PairStatus status = PAIR_SKIPPED;
+            // PAIR_COLLIDING only, relative to the first body
+            CollisionBodyComponent::CollisionType collisionType = CollisionBodyComponent::Cb1BottomEdgeCollidingWithCb2TopEdge;
+        };
+        // Detect phase result of each candidate pair, same index
+        std::vector<DetectedPair> mDetectedPairs;
+        // Pairs resolved this tick, which join their bodies into islands
+        std::vector<CollisionPair> mCollidingPairs;
+        // Bodies whose boxes were refreshed by the resolution of an earlier pair this tick
+        std::vector<bool> mIsBodyMoved;
+        // Bodies the resolution pushed out of their swept box, which the broadphases do not know about. Spatial queries
+        // test them one by one.
+        std::vector<bool> mIsBodyEscaped;
+        std::vector<CollisionBodyIndex> mEscapedBodies;
+        // Box covering the boxes of every body next tick, which bounds the search of QueryNearest
+        Rectangle<float> mBodiesBounds;
+        // Scratch buffers of the spatial queries
+        std::vector<CollisionBodyIndex> mQueryBodies;
+        std::vector<std::pair<float, CollisionBodyIndex>> mQueryDistances;
+        // Fills mQueryBodies with the bodies in the mask whose box next tick overlaps the region, once each
+        void CollectBodies(const Rectangle<float> &region, uint32_t maskBits);
+        // Candidate pairs with a sensor, only tested for overlap once the other pairs are resolved
+        std::vector<CollisionPair> mSensorPairs;
+        // Classifies a candidate pair from the snapshot. Reads nothing else, so pairs can be detected on any thread.
+        DetectedPair DetectPair(CollisionBodyIndex body1, CollisionBodyIndex body2) const;
+        // Recomputes the boxes of a body from its motion, after a collision moved it or a callback changed it.
+        void RefreshBodyBoxes(CollisionBodyIndex body);
+        // Refills the snapshot with the static and sleeping bodies only, and bins them
+        void RebuildStaticBodies();
+        void AddBodyToSnapshot(EntityId entityId, CollisionBodyComponent &collisionBodyComponent, const MotionComponent &motion);
+        /**
+         * @brief Swept test of 2 bodies, from their boxes this tick to their boxes next tick. Returns whether they collide,
+         * and if so the edges which collide, relative to body 1.
+         *
+         * Each axis gives the fraction of the tick during which the boxes overlap along it, from the motion of body 1
+         * relative to body 2. The boxes collide if these intervals meet during the tick, along the axis they meet last
+         * in. Boxes already overlapping this tick collide if they still do next tick, along the axis where they overlap
+         * the least.
+         */
+        bool SweepBodies(CollisionBodyIndex body1, CollisionBodyIndex body2, CollisionBodyComponent::CollisionType &collisionType) const;
+        // Same collision seen from the other body
+        static CollisionBodyComponent::CollisionType GetOppositeCollisionType(CollisionBodyComponent::CollisionType collisionType);
+        // Share of the overlap of 2 colliding bodies that body 1 moves back, from their speeds in the axis of the collision:
+        // the faster body moves back more. Bodies which are not dynamic do not move back at all.
+        static float GetCorrectionRatio(float velocity1, float velocity2, bool isDynamic1, bool isDynamic2);
+
+        // Pair of bodies which collided on the last tick they were checked
+        struct Contact {
+            // FROZEN_TICK while both bodies are resting, see IsEntityResting
+            uint32_t lastTick = 0;
+        };
+        static constexpr uint32_t FROZEN_TICK = UINT32_MAX;
+        // Contacts persist across ticks, so that enter and exit can be told apart from stay.
+        CollisionPairCache<Contact> mContacts;
+        std::vector<CollisionPairKey> mEndedContacts;
+        uint32_t mTick = 0;
+        // Pairs with a sensor which overlapped on the last tick they were checked, with that tick or FROZEN_TICK
+        CollisionPairCache<uint32_t> mOverlaps;
+        std::vector<CollisionPairKey> mEndedOverlaps;
+        // Tests the sensor pairs and updates mOverlaps, queueing the overlap events of the tick
+        void UpdateOverlaps();
+
+        enum CollisionEventType : uint8_t {
+            // Also calls the callback set with SetOnCollisionCallback
+            COLLISION_ENTER_EVENT,
+            COLLISION_STAY_EVENT,
+            COLLISION_EXIT_EVENT,
+            OVERLAP_ENTER_EVENT,
+            OVERLAP_EXIT_EVENT,
+        };
+        struct CollisionEvent {
+            EntityId receiverId;
+            EntityId otherEntityId;
+            CollisionEventType type;
+            // Collision enter and stay only, relative to the receiver
+            CollisionBodyComponent::CollisionType collisionType;
+        };
+        // Events of the current tick. Game callbacks may add or remove components, so nothing is called while the pairs
+        // are resolved: the resolution loop only appends here, and the callbacks run in DispatchEvents.
+        std::vector<CollisionEvent> mEvents;
+        bool mIsGroupEventsByReceiver = false;
+        size_t mNumEventsLastStep = 0;
+        void QueueEvent(EntityId receiverId, EntityId otherEntityId, CollisionEventType type, CollisionBodyComponent::CollisionType collisionType = CollisionBodyComponent::Cb1BottomEdgeCollidingWithCb2TopEdge);
+        // Calls the callbacks of the queued events. Each receiver is looked up again: bodies of ended pairs may have been
+        // removed since the last tick, and a callback adding a collision body moves the others in the storage.
+        void DispatchEvents();
+        // Sleeping bodies, in the static part of the snapshot after the static bodies
+        std::vector<CollisionBodyIndex> mSleepingBodies;
+        // Island of each sleeping body, kept here so that removing the body still wakes up its island
+        std::vector<uint32_t> mSleepingIslandIds;
+        // Static and kinematic bodies of the last snapshot which changed or were removed since, sorted
+        std::vector<EntityId> mChangedEntities;
+        // Islands to wake up at the end of the tick
+        std::vector<uint32_t> mWokenIslands;
+        uint32_t mNextIslandId = 1;
+        // Union-find of the moving bodies of the tick, and the fewest rest ticks of the bodies of each island at its root
+        std::vector<CollisionBodyIndex> mIslandParents;
+        std::vector<uint32_t> mIslandRestTicks;
+        std::vector<uint32_t> mIslandIds;
+        bool IsBodySleeping(CollisionBodyIndex body) const;
+        // Wakes up the bodies of mWokenIslands, which move again from the next tick
+        void WakeIslands();
+        // Wakes up the islands with a frozen contact with a static or kinematic body which changed or was removed since
+        // the last snapshot. Called before the snapshot is rebuilt.
+        void WakeIslandsOfChangedBodies();
+        // Counts the rest ticks of the moving bodies and puts to sleep the islands at rest for SLEEP_TICKS
+        void UpdateSleepingBodies();
+        CollisionBodyIndex FindIslandRoot(CollisionBodyIndex body);
+        // Whether a body is not checked against static bodies: a static, kinematic or sleeping body
+        bool IsEntityResting(EntityId entityId) const;
+    };
+
+    template<>
+    struct ComponentTraits<CollisionBodyComponent> {
+        static constexpr ComponentType TYPE = COLLISION_BODY;
+        typedef CollisionBodyComponentManager Manager;
     };
 };
 
@@ -4,19 +4,28 @@
 #include <simple-2d/component.h>
 
 namespace simple_2d {
+    class MotionComponent;
+
     class DownwardGravity : public Component {
     public:
         DownwardGravity(EntityId entityId);
         ~DownwardGravity() = default;
-        Error Step() override;
+        // Sets the vertical acceleration of the entity's motion.
+        Error Step(MotionComponent &motion);
     };
 
-    class DownwardGravityComponentManager : public ComponentManager {
+    class DownwardGravityComponentManager : public PackedComponentManager<DownwardGravity> {
     public:
         DownwardGravityComponentManager();
         ~DownwardGravityComponentManager() = default;
         void DoStep() override;
     };
+
+    template<>
+    struct ComponentTraits<DownwardGravity> {
+        static constexpr ComponentType TYPE = DOWNWARD_GRAVITY;
+        typedef DownwardGravityComponentManager Manager;
+    };
 }
 
 #endif // SIMPLE_2D_DOWNWARD_GRAVITY_H
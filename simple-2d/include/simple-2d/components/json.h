@@ -10,16 +10,22 @@ namespace simple_2d {
         ~JsonComponent();
         void SetJson(const nlohmann::json& json);
         nlohmann::json GetJson() const;
-        Error Step() override;
+        Error Step();
     private:
         nlohmann::json mJson;
     };
 
-    class JsonComponentManager : public ComponentManager {
+    class JsonComponentManager : public PackedComponentManager<JsonComponent> {
     public:
         JsonComponentManager();
         ~JsonComponentManager() = default;
         void DoStep() override;
     };
+
+    template<>
+    struct ComponentTraits<JsonComponent> {
+        static constexpr ComponentType TYPE = JSON;
+        typedef JsonComponentManager Manager;
+    };
 }
 #endif // SIMPLE_2D_COMPONENTS_JSON_H
@@ -6,6 +6,8 @@
 #include <memory>
 
 namespace simple_2d {
+    class CollisionBodyComponentManager;
+
     class MotionComponent: public Component {
     public:
         MotionComponent(EntityId entityId);
@@ -30,19 +32,54 @@ namespace simple_2d {
         float GetAccelerationOneAxis(Axis axis) const;
         void IncrementAcceleration(XYCoordinate<float> acceleration);
         void IncrementAccelerationOneAxis(Axis axis, float acceleration);
-        Error Step() override;
+        // A sleeping body is at rest: the motion step and gravity skip it. Bodies are put to sleep by the collision
+        // manager, see CollisionBodyComponentManager, and woken up by any of the setters above which changes a value.
+        // Setting the same value every tick, e.g. a velocity of 0 while no key is pressed, lets the body sleep.
+        bool IsAwake() const;
+        void WakeUp();
+        Error Step();
     private:
+        friend class CollisionBodyComponentManager;
+        // Stops the body and puts it to sleep
+        void Sleep();
+        // Wakes the body up if the value changes
+        void WakeUpIfChanged(float value, float newValue);
+        void WakeUpIfChanged(XYCoordinate<float> value, XYCoordinate<float> newValue);
+
         XYCoordinate<float> mPosition;
         XYCoordinate<float> mVelocity;
         XYCoordinate<float> mAcceleration;
+        bool mIsAwake = true;
     };
 
-    class MotionComponentManager : public ComponentManager {
+    class MotionComponentManager : public PackedComponentManager<MotionComponent> {
     public:
         MotionComponentManager();
         ~MotionComponentManager() = default;
         void DoStep() override;
     };
+
+    template<>
+    struct ComponentTraits<MotionComponent> {
+        static constexpr ComponentType TYPE = MOTION;
+        typedef MotionComponentManager Manager;
+    };
+
+    /**
+     * @class MotionBoundComponent
+     * @brief Base of the components placed by the motion component of their entity, e.g. sprites and collision bodies.
+     *
+     * Keeps a ComponentRef to the motion component, so looking it up costs O(1). The manager of the derived component
+     * binds it from BindComponent, when the component is added.
+     */
+    class MotionBoundComponent : public Component {
+    public:
+        void BindMotion(const PackedComponentStorage<MotionComponent> *motionStorage);
+        // Nullptr if the entity has no motion component.
+        MotionComponent* GetMotion() const;
+    protected:
+        ComponentRef<MotionComponent> mMotion;
+    };
 }
 
 
@@ -2,11 +2,12 @@
 #define SIMPLE_2D_COMPONENT_STATIC_REPETITIVE_SPRITE_H
 
 #include <simple-2d/component.h>
+#include <simple-2d/components/motion.h>
 #include <simple-2d/geometry.h>
 #include <simple-2d/graphics.h>
 
 namespace simple_2d {
-    class StaticRepetitiveSpriteComponent: public Component {
+    class StaticRepetitiveSpriteComponent : public MotionBoundComponent {
     public:
         StaticRepetitiveSpriteComponent(EntityId entityId);
         StaticRepetitiveSpriteComponent(EntityId entityId, ManagedSurface surface, XYCoordinate<float> position);
@@ -18,7 +19,7 @@ namespace simple_2d {
         RectangularDimensions<int> GetDimensions() const;
         void SetOffset(XYCoordinate<float> offset);
         XYCoordinate<float> GetOffset() const;
-        Error Step() override;
+        Error Step();
     private:
         XYCoordinate<float> mOffset;
         RectangularDimensions<int> mDimensions;
@@ -28,11 +29,19 @@ namespace simple_2d {
         void RebuildTexture();
     };
 
-    class StaticRepetitiveSpriteComponentManager : public ComponentManager {
+    class StaticRepetitiveSpriteComponentManager : public PackedComponentManager<StaticRepetitiveSpriteComponent> {
     public:
         StaticRepetitiveSpriteComponentManager();
         ~StaticRepetitiveSpriteComponentManager() = default;
         void DoStep() override;
+    protected:
+        void BindComponent(StaticRepetitiveSpriteComponent &staticRepetitiveSprite) override;
+    };
+
+    template<>
+    struct ComponentTraits<StaticRepetitiveSpriteComponent> {
+        static constexpr ComponentType TYPE = STATIC_REPETITIVE_SPRITE;
+        typedef StaticRepetitiveSpriteComponentManager Manager;
     };
 }; // simple_2d
 
@@ -4,10 +4,11 @@
 #include <simple-2d/geometry.h>
 #include <simple-2d/graphics.h>
 #include <simple-2d/component.h>
+#include <simple-2d/components/motion.h>
 #include <map>
 
 namespace simple_2d {
-    class StaticSpriteComponent: public Component {
+    class StaticSpriteComponent : public MotionBoundComponent {
     public:
         StaticSpriteComponent(EntityId entityId);
         StaticSpriteComponent(EntityId entityId, ManagedTexture bundle);
@@ -17,18 +18,27 @@ namespace simple_2d {
         void SetOffset(XYCoordinate<float> offset);
         ManagedTexture GetTexture() const;
         XYCoordinate<float> GetOffset() const;
-        Error Step() override;
+        // Draws the sprite at the entity's position.
+        Error Step();
     private:
         // Offset from the entity's position to the top-left corner of the sprite
         XYCoordinate<float> mOffset;
         ManagedTexture mTexture;
     };
 
-    class StaticSpriteComponentManager : public ComponentManager {
+    class StaticSpriteComponentManager : public PackedComponentManager<StaticSpriteComponent> {
     public:
         StaticSpriteComponentManager();
         ~StaticSpriteComponentManager() = default;
         void DoStep() override;
+    protected:
+        void BindComponent(StaticSpriteComponent &staticSprite) override;
+    };
+
+    template<>
+    struct ComponentTraits<StaticSpriteComponent> {
+        static constexpr ComponentType TYPE = STATIC_SPRITE;
+        typedef StaticSpriteComponentManager Manager;
     };
 }; // simple_2d
 
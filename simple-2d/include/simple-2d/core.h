@@ -9,6 +9,7 @@
 #include <SDL3/SDL_events.h>
 #include "camera.h"
 #include "scene.h"
+#include "worker_pool.h"
 
 namespace simple_2d {
     /**
@@ -23,6 +24,7 @@ namespace simple_2d {
         Camera mCamera;
         Error pollEvents();
         std::shared_ptr<Scene> mCurrentScene;
+        WorkerPool mWorkerPool;
     public:
         /**
          * @brief Constructs the Engine object.
@@ -62,6 +64,11 @@ namespace simple_2d {
 
         Camera& GetCamera();
 
+        /**
+         * @brief Threads used to step the component managers of a scene in parallel. See Scene::Step.
+         */
+        WorkerPool& GetWorkerPool();
+
         Error SetCurrentScene(std::shared_ptr<Scene> scene);
 
         std::shared_ptr<Scene> GetCurrentScene() const;
@@ -76,6 +83,16 @@ namespace simple_2d {
         Error PrepareTextureForRendering(const ManagedTexture &texture, XYCoordinate<float> pos);
 
         std::shared_ptr<ComponentManager> GetComponentManager(ComponentType componentType) const;
+
+        /**
+         * @brief Gets component T of an entity in the current scene without any cast or virtual call.
+         *
+         * @return The component, or nullptr if the entity has none.
+         */
+        template<typename T>
+        T* GetComponent(EntityId entityId) const {
+            return mCurrentScene->GetComponent<T>(entityId);
+        }
         std::vector<SDL_Event> GetEvents() const;
     };
 };
@@ -7,6 +7,7 @@
 #include <map>
 #include "component.h"
 #include "generic_types.h"
+#include "core.h"
 
 namespace simple_2d {
 
@@ -17,9 +18,20 @@ namespace simple_2d {
         ~Entity();
         EntityId GetEntityId() const;
         Error AddComponent(ComponentType componentType);
-        std::shared_ptr<Component> GetComponent(ComponentType componentType) const;
+        Component* GetComponent(ComponentType componentType) const;
+
+        // Typed variants of the above. The header of T must be included by the caller.
+        template<typename T>
+        Error AddComponent() {
+            return AddComponent(ComponentTraits<T>::TYPE);
+        }
+
+        template<typename T>
+        T* GetComponent() const {
+            return Engine::GetInstance().GetComponent<T>(mEntityId);
+        }
     protected:
-        EntityId mEntityId; // Entity ID is unique for each entity.
+        EntityId mEntityId; // Entity ID is unique for each live entity of the scene. See EntityRegistry.
     };
 }
 
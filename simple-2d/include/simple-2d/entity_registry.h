@@ -0,0 +1,63 @@
+#ifndef SIMPLE_2D_ENTITY_REGISTRY_H
+#define SIMPLE_2D_ENTITY_REGISTRY_H
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "generic_types.h"
+#include "component.h"
+
+namespace simple_2d {
+    /**
+     * @class EntityRegistry
+     * @brief Hands out generational entity ids and recycles the indices of deleted entities.
+     *
+     * Live entity indices stay compact (bounded by the peak number of live entities), so per-entity tables indexed by
+     * GetEntityIndex() stay small no matter how long the game runs.
+     */
+    class EntityRegistry {
+    public:
+        EntityRegistry() = default;
+        ~EntityRegistry() = default;
+        // Returns INVALID_ENTITY_ID if all indices are in use.
+        EntityId Create();
+        // Releases the index of the entity and bumps its generation. Does nothing if the id is stale.
+        void Destroy(EntityId id);
+        // False for ids whose entity has been destroyed, even if the index now belongs to another entity.
+        bool IsAlive(EntityId id) const;
+        size_t GetNumAliveEntities() const;
+        // Number of indices ever allocated, i.e. the size a table indexed by entity index needs.
+        size_t GetIndexCapacity() const;
+        // Components the entity has. Zero for ids that are not alive.
+        ComponentMask GetComponentMask(EntityId id) const;
+        // Does nothing if the id is not alive.
+        void SetComponentBit(EntityId id, ComponentType componentType, bool hasComponent);
+        /**
+         * @brief Calls fn(EntityId) for every live entity having at least all the components of the mask, in index order.
+         * The mask must not be empty.
+         */
+        template<typename Function>
+        void ForEachEntityWith(ComponentMask mask, Function &&fn) const {
+            if (mask == 0) {
+                return;
+            }
+            for (uint32_t index = 0; index < mComponentMasks.size(); index++) {
+                // Freed indices have an empty mask, so they never match
+                if ((mComponentMasks[index] & mask) == mask) {
+                    fn(MakeEntityId(index, mGenerations[index]));
+                }
+            }
+        }
+    private:
+        // Freed indices are only recycled once this many are queued. Together with the FIFO order this spreads reuse over
+        // many indices, so a generation takes much longer to wrap around.
+        static constexpr size_t MIN_FREE_INDICES = 1024;
+        std::vector<uint32_t> mGenerations;
+        // Indexed by entity index, like mGenerations
+        std::vector<ComponentMask> mComponentMasks;
+        std::deque<uint32_t> mFreeIndices;
+        size_t mNumAliveEntities = 0;
+    };
+}
+
+#endif // SIMPLE_2D_ENTITY_REGISTRY_H
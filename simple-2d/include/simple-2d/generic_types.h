@@ -5,8 +5,31 @@
 
 namespace simple_2d {
 
+    /**
+     * An entity id is a generational handle: the low ENTITY_INDEX_BITS bits are an index that is recycled once the entity is
+     * deleted, the high bits are the generation of that index. The generation is bumped on every deletion, so an id kept
+     * around after its entity was deleted no longer matches the entity that reuses the index.
+     */
     typedef uint32_t EntityId;
 
+    constexpr uint32_t ENTITY_INDEX_BITS = 20;
+    constexpr uint32_t ENTITY_INDEX_MASK = (uint32_t(1) << ENTITY_INDEX_BITS) - 1;
+    constexpr uint32_t ENTITY_GENERATION_MASK = (uint32_t(1) << (32 - ENTITY_INDEX_BITS)) - 1;
+    // Index ENTITY_INDEX_MASK is never handed out, so this id never refers to an entity.
+    constexpr EntityId INVALID_ENTITY_ID = UINT32_MAX;
+
+    constexpr uint32_t GetEntityIndex(EntityId id) {
+        return id & ENTITY_INDEX_MASK;
+    }
+
+    constexpr uint32_t GetEntityGeneration(EntityId id) {
+        return id >> ENTITY_INDEX_BITS;
+    }
+
+    constexpr EntityId MakeEntityId(uint32_t index, uint32_t generation) {
+        return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK);
+    }
+
     /**
      * @struct Color
      * @brief Represents a color with red, green, blue, and alpha components.
@@ -3,22 +3,83 @@
 
 #include "geometry.h"
 #include "component.h"
+#include "view.h"
+#include "entity_registry.h"
 
 namespace simple_2d {
     class Scene {
     private:
         bool mIsInitialized = false;
+        // Declared before the managers so that it outlives their storages
+        ComponentArena mComponentArena;
         RectangularDimensions<int> mDimensions;
         std::shared_ptr<ComponentManager> mComponentManagers[MAX_COMPONENT_TYPES];
         std::vector<EntityId> mEntityIdsToDelete;
+        // Managers stepped each tick, grouped in stages. The managers of a stage have no conflicting component access and
+        // may run at the same time; stages run one after another. See BuildStepStages.
+        std::vector<std::vector<ComponentType>> mStepStages;
+        EntityRegistry mEntityRegistry;
     public:
         Scene(RectangularDimensions<int> dimensions);
-        ~Scene() = default;
+        ~Scene();
         Error Init();
         RectangularDimensions<int> GetDimensions() const;
         std::shared_ptr<ComponentManager> GetComponentManager(ComponentType componentType) const;
+
+        // Typed manager of component T, resolved at compile time through ComponentTraits<T>. The header of T must be
+        // included by the caller.
+        template<typename T>
+        typename ComponentTraits<T>::Manager* GetComponentManager() const {
+            return static_cast<typename ComponentTraits<T>::Manager *>(mComponentManagers[ComponentTraits<T>::TYPE].get());
+        }
+
+        // Component T of the entity, or nullptr if the entity has none.
+        template<typename T>
+        T* GetComponent(EntityId entityId) const {
+            auto componentManager = GetComponentManager<T>();
+            if (componentManager == nullptr) {
+                return nullptr;
+            }
+            return componentManager->Get(entityId);
+        }
+
+        // Joined iteration over the entities having all the components Ts, see View.
+        template<typename... Ts>
+        simple_2d::View<Ts...> View() const {
+            return simple_2d::View<Ts...>(GetComponentManager<Ts>()...);
+        }
+        // Memory used by the components of the type, see ComponentArena.
+        ComponentMemoryStats GetComponentMemoryStats(ComponentType componentType) const;
+        // Heap memory reserved for all components of the scene.
+        size_t GetComponentMemoryReserved() const;
+        // Allocates the id of a new entity of this scene. Ids of deleted entities are recycled with a new generation.
+        EntityId CreateEntityId();
+        // False once the entity has been deleted, even if its index was reused by another entity.
+        bool IsEntityAlive(EntityId entityId) const;
         void RequestDeleteEntity(EntityId entityId);
+        // Components the entity has, one bit per ComponentType. Zero once the entity is deleted.
+        ComponentMask GetComponentMask(EntityId entityId) const;
+        // Kept up to date by the component managers whenever a component is added or removed.
+        void SetComponentBit(EntityId entityId, ComponentType componentType, bool hasComponent);
+
+        // True if the entity has all the components Ts. Costs one array access, whatever the number of components.
+        template<typename... Ts>
+        bool HasComponents(EntityId entityId) const {
+            constexpr auto mask = MakeComponentMask<Ts...>();
+            return (GetComponentMask(entityId) & mask) == mask;
+        }
+
+        // Calls fn(EntityId) for every entity having all the components of the mask, see EntityRegistry::ForEachEntityWith.
+        template<typename Function>
+        void ForEachEntityWith(ComponentMask mask, Function &&fn) const {
+            mEntityRegistry.ForEachEntityWith(mask, std::forward<Function>(fn));
+        }
         Error Step();
+    private:
+        // Places every manager in the first stage after the last stage holding a manager it conflicts with, walking them in
+        // their serial step order. Managers sharing data therefore keep their relative order.
+        void BuildStepStages();
+        void StepStage(const std::vector<ComponentType> &stage);
     };
 }
 #endif // SIMPLE_2D_SCENE_H
@@ -0,0 +1,130 @@
+#ifndef SIMPLE_2D_VIEW_H
+#define SIMPLE_2D_VIEW_H
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "component.h"
+#include "generic_types.h"
+
+namespace simple_2d {
+    /**
+     * @class View
+     * @brief Joined iteration over the entities that have all the components Ts.
+     *
+     * A view walks the storage of one component type (the driver) and probes the other storages by entity id, so each
+     * candidate costs one sparse-array lookup per extra component instead of a trip through Engine, Scene and a
+     * type-erased manager. The callback receives the entity id and a reference to every component:
+     *
+     *     scene.View<DownwardGravity, MotionComponent>().ForEach(
+     *         [](EntityId id, DownwardGravity &gravity, MotionComponent &motion) { ... });
+     *
+     * Like iterating a single storage, components added during iteration are not visited. Components must not be removed
+     * during iteration, which is guaranteed inside a manager step (see ComponentManager::RemoveComponentOfEntity).
+     *
+     * Obtain views with Scene::View<Ts...>(). The headers of all Ts must be included by the caller.
+     */
+    template<typename... Ts>
+    class View {
+    public:
+        explicit View(typename ComponentTraits<Ts>::Manager*... componentManagers) : mComponentManagers(componentManagers...) {
+        }
+
+        /**
+         * @brief Calls fn(EntityId, Ts&...) for every entity having all the components. The smallest storage drives the
+         * iteration (the first listed type on ties), so the order is the storage order of that type.
+         */
+        template<typename Function>
+        void ForEach(Function &&fn) const {
+            if (!IsValid()) {
+                return;
+            }
+            auto driver = FindSmallestStorage(std::index_sequence_for<Ts...>{});
+            ForEachDrivenBy(driver, fn, std::index_sequence_for<Ts...>{});
+        }
+
+        /**
+         * @brief Same as ForEach, but always iterates in the storage order of Driver, which must be one of Ts. Use it when
+         * the order matters, e.g. sprites are drawn in the order of their own storage.
+         */
+        template<typename Driver, typename Function>
+        void ForEachIn(Function &&fn) const {
+            if (!IsValid()) {
+                return;
+            }
+            ForEachDrivenBy(IndexOf<Driver>(std::index_sequence_for<Ts...>{}), fn, std::index_sequence_for<Ts...>{});
+        }
+
+        // Upper bound of the number of entities visited: the size of the smallest storage.
+        size_t SizeHint() const {
+            if (!IsValid()) {
+                return 0;
+            }
+            return SmallestSize(std::index_sequence_for<Ts...>{});
+        }
+
+    private:
+        bool IsValid() const {
+            return std::apply([](auto*... componentManagers) { return ((componentManagers != nullptr) && ...); }, mComponentManagers);
+        }
+
+        template<size_t... Is>
+        size_t FindSmallestStorage(std::index_sequence<Is...>) const {
+            size_t smallest = 0;
+            size_t smallestSize = SIZE_MAX;
+            ((std::get<Is>(mComponentManagers)->GetStorage().Size() < smallestSize ?
+                (smallest = Is, smallestSize = std::get<Is>(mComponentManagers)->GetStorage().Size()) : 0), ...);
+            return smallest;
+        }
+
+        template<size_t... Is>
+        size_t SmallestSize(std::index_sequence<Is...> sequence) const {
+            auto driver = FindSmallestStorage(sequence);
+            size_t size = 0;
+            ((Is == driver ? (size = std::get<Is>(mComponentManagers)->GetStorage().Size()) : 0), ...);
+            return size;
+        }
+
+        template<typename Driver, size_t... Is>
+        static constexpr size_t IndexOf(std::index_sequence<Is...>) {
+            static_assert((std::is_same_v<Driver, Ts> || ...), "Driver must be one of the view's component types");
+            size_t index = 0;
+            ((std::is_same_v<Driver, Ts> ? (index = Is) : 0), ...);
+            return index;
+        }
+
+        template<typename Function, size_t... Is>
+        void ForEachDrivenBy(size_t driver, Function &fn, std::index_sequence<Is...> sequence) const {
+            ((driver == Is ? (Iterate<Is>(fn, sequence), 0) : 0), ...);
+        }
+
+        // Walks the storage of the Driver-th type and probes the others.
+        template<size_t Driver, typename Function, size_t... Is>
+        void Iterate(Function &fn, std::index_sequence<Is...>) const {
+            auto &driverStorage = std::get<Driver>(mComponentManagers)->GetStorage();
+            auto size = driverStorage.Size();
+            for (size_t index = 0; index < size; index++) {
+                auto entityId = driverStorage.EntityAt(index);
+                std::tuple<Ts*...> components(Probe<Is, Driver>(entityId, index)...);
+                if (((std::get<Is>(components) != nullptr) && ...)) {
+                    fn(entityId, *std::get<Is>(components)...);
+                }
+            }
+        }
+
+        template<size_t I, size_t Driver>
+        auto Probe(EntityId entityId, size_t driverIndex) const {
+            auto &storage = std::get<I>(mComponentManagers)->GetStorage();
+            if constexpr (I == Driver) {
+                return &storage.At(driverIndex);
+            } else {
+                return storage.Find(entityId);
+            }
+        }
+
+        std::tuple<typename ComponentTraits<Ts>::Manager*...> mComponentManagers;
+    };
+}; // simple_2d
+
+#endif // SIMPLE_2D_VIEW_H
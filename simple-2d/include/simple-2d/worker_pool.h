@@ -0,0 +1,124 @@
+#ifndef SIMPLE_2D_WORKER_POOL_H
+#define SIMPLE_2D_WORKER_POOL_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace simple_2d {
+    /**
+     * @class WorkerPool
+     * @brief Work-stealing thread pool running tasks submitted from the game loop.
+     *
+     * Every thread owns a deque of tasks. A thread pushes and pops its own tasks at the back, which keeps recently
+     * submitted (cache-hot) work local, and steals from the front of the other threads' deques when it runs out. Threads
+     * that are not part of the pool submit to a shared deque which everybody steals from.
+     *
+     * Tasks are submitted to a TaskGroup and the submitter waits for the group. While waiting, the calling thread runs
+     * tasks itself, so a pool of N threads has N - 1 workers plus the caller, and a task may submit and wait for a
+     * nested group (e.g. a ParallelFor inside a manager stepped by the scene scheduler) without deadlocking.
+     *
+     * Threads are started on first use, so engines that never run anything in parallel never start them.
+     */
+    class WorkerPool {
+    public:
+        // Chunk size used by ParallelFor when the caller gives no hint.
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 1024;
+
+        class TaskGroup {
+        public:
+            TaskGroup() = default;
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+        private:
+            friend class WorkerPool;
+            std::atomic<size_t> mNumPendingTasks = 0;
+        };
+
+        struct ParallelForOptions {
+            // Number of consecutive indices per task. 0 means DEFAULT_CHUNK_SIZE, or a size derived from the number of
+            // threads when not deterministic. Small chunks balance load better, large chunks cost less scheduling.
+            size_t chunkSize = 0;
+            // Chunk boundaries only depend on the range and chunkSize, never on the number of threads. As long as every
+            // index is processed independently of the others, results are then the same with 1 thread or 16.
+            bool isDeterministic = true;
+        };
+
+        WorkerPool();
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        ~WorkerPool();
+        // Number of threads running tasks, the calling thread included. Defaults to the number of hardware threads. Must
+        // not be called while tasks are pending.
+        void SetNumThreads(size_t numThreads);
+        size_t GetNumThreads() const;
+        void Submit(TaskGroup &group, std::function<void()> task);
+        // Returns once every task of the group is done. Runs queued tasks (of any group) in the meantime.
+        void Wait(TaskGroup &group);
+
+        /**
+         * @brief Calls fn(chunkBegin, chunkEnd) over [0, count) split in chunks, on all threads, and returns once every
+         * chunk is done. Runs inline when there is a single chunk or a single thread.
+         */
+        template<typename Function>
+        void ParallelFor(size_t count, Function &&fn, ParallelForOptions options = {}) {
+            auto chunkSize = GetChunkSize(count, options);
+            if (count <= chunkSize || mNumThreads == 1) {
+                if (count > 0) {
+                    fn(size_t(0), count);
+                }
+                return;
+            }
+            TaskGroup group;
+            std::vector<std::function<void()>> chunks;
+            chunks.reserve((count + chunkSize - 1) / chunkSize);
+            for (size_t begin = 0; begin < count; begin += chunkSize) {
+                auto end = std::min(count, begin + chunkSize);
+                chunks.emplace_back([&fn, begin, end] { fn(begin, end); });
+            }
+            SubmitBatch(group, chunks);
+            Wait(group);
+        }
+    private:
+        struct Task {
+            std::function<void()> function;
+            TaskGroup *group;
+        };
+
+        struct TaskQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        size_t GetChunkSize(size_t count, const ParallelForOptions &options) const;
+        // Submits all tasks, then wakes the threads once.
+        void SubmitBatch(TaskGroup &group, std::vector<std::function<void()>> &tasks);
+        void Start();
+        void Stop();
+        void WorkerLoop(size_t queueIndex);
+        // Index of the calling thread's own queue. Threads outside the pool share queue 0.
+        size_t GetOwnQueueIndex() const;
+        // Pops a task from the thread's own queue, or steals one from another queue.
+        bool FindTask(size_t ownQueueIndex, Task &task);
+        void RunTask(Task &task);
+        void CountQueued(size_t numTasks);
+
+        size_t mNumThreads;
+        std::vector<std::thread> mThreads;
+        // Queue 0 is shared by threads outside the pool, queue i > 0 belongs to worker thread i.
+        std::vector<std::unique_ptr<TaskQueue>> mQueues;
+        std::atomic<size_t> mNumQueuedTasks = 0;
+        // Guards sleeping: idle threads sleep on mWakeUp until tasks are queued, a group completes or the pool stops.
+        std::mutex mSleepMutex;
+        std::condition_variable mWakeUp;
+        bool mIsStopping = false;
+    };
+}
+
+#endif // SIMPLE_2D_WORKER_POOL_H
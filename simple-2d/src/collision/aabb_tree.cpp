@@ -0,0 +1,361 @@
+#include <simple-2d/collision/aabb_tree.h>
+#include <algorithm>
+#include <limits>
+
+// Boxes are compared by their perimeter, the 2D counterpart of the surface area heuristic: the chance that a random query
+// enters a node grows with the perimeter of its box.
+template<typename Box>
+static float getPerimeter(const Box &box) {
+    return 2 * ((box.maxX - box.minX) + (box.maxY - box.minY));
+}
+
+template<typename Box1, typename Box2>
+static float getUnionPerimeter(const Box1 &box1, const Box2 &box2) {
+    auto width = std::max(box1.maxX, box2.maxX) - std::min(box1.minX, box2.minX);
+    auto height = std::max(box1.maxY, box2.maxY) - std::min(box1.minY, box2.minY);
+    return 2 * (width + height);
+}
+
+template<typename Box, typename Box1, typename Box2>
+static void setUnion(Box &box, const Box1 &box1, const Box2 &box2) {
+    box.minX = std::min(box1.minX, box2.minX);
+    box.minY = std::min(box1.minY, box2.minY);
+    box.maxX = std::max(box1.maxX, box2.maxX);
+    box.maxY = std::max(box1.maxY, box2.maxY);
+}
+
+template<typename Function>
+void simple_2d::AabbTree::Query(float minX, float minY, float maxX, float maxY, Function &&fn) {
+    if (mRoot == NULL_NODE) {
+        return;
+    }
+    mStack.clear();
+    mStack.push_back(mRoot);
+    while (!mStack.empty()) {
+        auto id = mStack.back();
+        mStack.pop_back();
+        auto &node = mNodes[id];
+        if (!(node.minX <= maxX && minX <= node.maxX && node.minY <= maxY && minY <= node.maxY)) {
+            continue;
+        }
+        if (node.IsLeaf()) {
+            fn(id);
+        } else {
+            mStack.push_back(node.child1);
+            mStack.push_back(node.child2);
+        }
+    }
+}
+
+void simple_2d::AabbTree::Update(const std::vector<EntityId> &entities, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) {
+    mUpdate++;
+    for (auto body = begin; body < end; body++) {
+        auto entityId = entities[body];
+        auto entityIndex = GetEntityIndex(entityId);
+        if (entityIndex >= mEntityLeaves.size()) {
+            mEntityLeaves.resize(entityIndex + 1, NULL_NODE);
+        }
+        auto leaf = mEntityLeaves[entityIndex];
+        if (leaf == NULL_NODE || mNodes[leaf].entityId != entityId) {
+            leaf = AllocateNode();
+            mNodes[leaf].entityId = entityId;
+            SetFattenedBox(mNodes[leaf], boxes, body);
+            InsertLeaf(leaf);
+            mEntityLeaves[entityIndex] = leaf;
+            mLeaves.push_back(leaf);
+        } else {
+            auto &node = mNodes[leaf];
+            auto isInsideLeaf = node.minX <= boxes.minX[body] && node.minY <= boxes.minY[body] &&
+                                boxes.maxX[body] <= node.maxX && boxes.maxY[body] <= node.maxY;
+            if (!isInsideLeaf) {
+                RemoveLeaf(leaf);
+                SetFattenedBox(mNodes[leaf], boxes, body);
+                InsertLeaf(leaf);
+            }
+        }
+        mNodes[leaf].body = body;
+        mNodes[leaf].lastUpdate = mUpdate;
+    }
+    // Remove the leaves of the bodies which were not part of this update
+    for (size_t i = 0; i < mLeaves.size();) {
+        auto leaf = mLeaves[i];
+        if (mNodes[leaf].lastUpdate == mUpdate) {
+            i++;
+            continue;
+        }
+        auto entityIndex = GetEntityIndex(mNodes[leaf].entityId);
+        // The entity index may have been recycled by a new entity, which already has its own leaf
+        if (mEntityLeaves[entityIndex] == leaf) {
+            mEntityLeaves[entityIndex] = NULL_NODE;
+        }
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+        mLeaves[i] = mLeaves.back();
+        mLeaves.pop_back();
+    }
+}
+
+void simple_2d::AabbTree::FindPairs(std::vector<CollisionPair> &pairs) {
+    auto start = pairs.size();
+    // Query the leaves in tree order, so that consecutive queries walk mostly the same nodes, which are still in cache
+    mQueryLeaves.clear();
+    Query(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), [this](NodeId leaf) {
+        mQueryLeaves.push_back(leaf);
+    });
+    for (auto leaf : mQueryLeaves) {
+        auto &node = mNodes[leaf];
+        auto body1 = node.body;
+        Query(node.minX, node.minY, node.maxX, node.maxY, [this, body1, &pairs](NodeId otherLeaf) {
+            // Each pair is found from both of its leaves, keep one
+            auto body2 = mNodes[otherLeaf].body;
+            if (body1 < body2 && ShouldCollide(body1, body2)) {
+                pairs.push_back({body1, body2});
+            }
+        });
+    }
+    // The order in which the tree is walked depends on its shape, which depends on the history of the bodies. Sort the
+    // pairs so that they only depend on the bodies.
+    std::sort(pairs.begin() + start, pairs.end(), [](const CollisionPair &pair1, const CollisionPair &pair2) {
+        return pair1.first != pair2.first ? pair1.first < pair2.first : pair1.second < pair2.second;
+    });
+}
+
+void simple_2d::AabbTree::FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) {
+    for (auto body2 = begin; body2 < end; body2++) {
+        auto start = pairs.size();
+        Query(boxes.minX[body2], boxes.minY[body2], boxes.maxX[body2], boxes.maxY[body2], [this, body2, &pairs](NodeId leaf) {
+            auto body1 = mNodes[leaf].body;
+            if (ShouldCollide(body1, body2)) {
+                pairs.push_back({body1, body2});
+            }
+        });
+        std::sort(pairs.begin() + start, pairs.end(), [](const CollisionPair &pair1, const CollisionPair &pair2) {
+            return pair1.first < pair2.first;
+        });
+    }
+}
+
+void simple_2d::AabbTree::QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) {
+    Query(region.top_left.x, region.top_left.y, region.bottom_right.x, region.bottom_right.y, [this, &bodies](NodeId leaf) {
+        bodies.push_back(mNodes[leaf].body);
+    });
+}
+
+int32_t simple_2d::AabbTree::GetHeight() const {
+    return mRoot == NULL_NODE ? -1 : mNodes[mRoot].height;
+}
+
+simple_2d::AabbTree::NodeId simple_2d::AabbTree::AllocateNode() {
+    if (mFreeList == NULL_NODE) {
+        mNodes.emplace_back();
+        return NodeId(mNodes.size() - 1);
+    }
+    auto node = mFreeList;
+    mFreeList = mNodes[node].parent;
+    mNodes[node] = Node();
+    return node;
+}
+
+void simple_2d::AabbTree::FreeNode(NodeId node) {
+    mNodes[node].parent = mFreeList;
+    mNodes[node].height = -1;
+    mFreeList = node;
+}
+
+void simple_2d::AabbTree::InsertLeaf(NodeId leaf) {
+    if (mRoot == NULL_NODE) {
+        mRoot = leaf;
+        mNodes[leaf].parent = NULL_NODE;
+        return;
+    }
+    auto sibling = FindBestSibling(leaf);
+    // Replace the sibling by a new parent of the sibling and the leaf
+    auto newParent = AllocateNode();
+    auto oldParent = mNodes[sibling].parent;
+    auto &parentNode = mNodes[newParent];
+    parentNode.parent = oldParent;
+    parentNode.child1 = sibling;
+    parentNode.child2 = leaf;
+    parentNode.height = mNodes[sibling].height + 1;
+    setUnion(parentNode, mNodes[sibling], mNodes[leaf]);
+    if (oldParent == NULL_NODE) {
+        mRoot = newParent;
+    } else if (mNodes[oldParent].child1 == sibling) {
+        mNodes[oldParent].child1 = newParent;
+    } else {
+        mNodes[oldParent].child2 = newParent;
+    }
+    mNodes[sibling].parent = newParent;
+    mNodes[leaf].parent = newParent;
+    RefitAncestors(newParent);
+}
+
+void simple_2d::AabbTree::RemoveLeaf(NodeId leaf) {
+    if (leaf == mRoot) {
+        mRoot = NULL_NODE;
+        return;
+    }
+    // The sibling takes the place of the parent
+    auto parent = mNodes[leaf].parent;
+    auto grandParent = mNodes[parent].parent;
+    auto sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2 : mNodes[parent].child1;
+    mNodes[sibling].parent = grandParent;
+    FreeNode(parent);
+    if (grandParent == NULL_NODE) {
+        mRoot = sibling;
+        return;
+    }
+    if (mNodes[grandParent].child1 == parent) {
+        mNodes[grandParent].child1 = sibling;
+    } else {
+        mNodes[grandParent].child2 = sibling;
+    }
+    RefitAncestors(grandParent);
+}
+
+void simple_2d::AabbTree::RefitAncestors(NodeId node) {
+    while (node != NULL_NODE) {
+        Rotate(node);
+        auto &current = mNodes[node];
+        auto &child1 = mNodes[current.child1];
+        auto &child2 = mNodes[current.child2];
+        current.height = 1 + std::max(child1.height, child2.height);
+        setUnion(current, child1, child2);
+        node = current.parent;
+    }
+}
+
+simple_2d::AabbTree::NodeId simple_2d::AabbTree::FindBestSibling(NodeId leaf) const {
+    // Branch and bound over the cost of inserting the leaf next to a node: the perimeter of the new parent, plus how much
+    // the perimeter of every ancestor grows. Descending can only add to the growth of the ancestors, which bounds the
+    // cost of a whole subtree.
+    auto &leafNode = mNodes[leaf];
+    auto leafPerimeter = getPerimeter(leafNode);
+    auto node = mRoot;
+    auto perimeter = getPerimeter(mNodes[node]);
+    auto directCost = getUnionPerimeter(mNodes[node], leafNode);
+    auto inheritedCost = 0.0f;
+    auto bestSibling = node;
+    auto bestCost = directCost;
+    while (!mNodes[node].IsLeaf()) {
+        auto cost = directCost + inheritedCost;
+        if (cost < bestCost) {
+            bestSibling = node;
+            bestCost = cost;
+        }
+        // Growth of this node, paid by any sibling below it
+        inheritedCost += directCost - perimeter;
+        auto child1 = mNodes[node].child1;
+        auto child2 = mNodes[node].child2;
+        auto isLeaf1 = mNodes[child1].IsLeaf();
+        auto isLeaf2 = mNodes[child2].IsLeaf();
+        auto directCost1 = getUnionPerimeter(mNodes[child1], leafNode);
+        auto directCost2 = getUnionPerimeter(mNodes[child2], leafNode);
+        auto perimeter1 = getPerimeter(mNodes[child1]);
+        auto perimeter2 = getPerimeter(mNodes[child2]);
+        // A leaf child can only be a sibling itself. Below an inner child, the new parent is at least as large as the leaf
+        // and the child grows by at least directCost - perimeter.
+        auto lowerCost1 = std::numeric_limits<float>::max();
+        auto lowerCost2 = std::numeric_limits<float>::max();
+        if (isLeaf1) {
+            if (directCost1 + inheritedCost < bestCost) {
+                bestSibling = child1;
+                bestCost = directCost1 + inheritedCost;
+            }
+        } else {
+            lowerCost1 = inheritedCost + directCost1 + std::min(leafPerimeter - perimeter1, 0.0f);
+        }
+        if (isLeaf2) {
+            if (directCost2 + inheritedCost < bestCost) {
+                bestSibling = child2;
+                bestCost = directCost2 + inheritedCost;
+            }
+        } else {
+            lowerCost2 = inheritedCost + directCost2 + std::min(leafPerimeter - perimeter2, 0.0f);
+        }
+        if ((isLeaf1 && isLeaf2) || (bestCost <= lowerCost1 && bestCost <= lowerCost2)) {
+            break;
+        }
+        if (!isLeaf1 && lowerCost1 <= lowerCost2) {
+            node = child1;
+            perimeter = perimeter1;
+            directCost = directCost1;
+        } else {
+            node = child2;
+            perimeter = perimeter2;
+            directCost = directCost2;
+        }
+    }
+    return bestSibling;
+}
+
+void simple_2d::AabbTree::Rotate(NodeId a) {
+    /*
+     *       a
+     *     /   \
+     *    b     c
+     *   / \   / \
+     *  d   e f   g
+     *
+     * Swapping b with f or g only changes the box of c, and swapping c with d or e only the box of b. Pick the swap which
+     * shrinks that box the most, if any.
+     */
+    auto &nodeA = mNodes[a];
+    if (nodeA.height < 2) {
+        return;
+    }
+    auto b = nodeA.child1;
+    auto c = nodeA.child2;
+    auto bestGain = 0.0f;
+    // Node moved up from below one child of a, and the child of a it is swapped with
+    auto bestGrandChild = NULL_NODE;
+    auto bestChild = NULL_NODE;
+    auto tryRotations = [this, &bestGain, &bestGrandChild, &bestChild](NodeId child, NodeId otherChild) {
+        auto &otherNode = mNodes[otherChild];
+        if (otherNode.IsLeaf()) {
+            return;
+        }
+        auto perimeter = getPerimeter(otherNode);
+        // child takes the place of one grandchild, which leaves otherChild with child and the other grandchild
+        auto gain1 = perimeter - getUnionPerimeter(mNodes[child], mNodes[otherNode.child2]);
+        auto gain2 = perimeter - getUnionPerimeter(mNodes[child], mNodes[otherNode.child1]);
+        if (gain1 > bestGain) {
+            bestGain = gain1;
+            bestGrandChild = otherNode.child1;
+            bestChild = child;
+        }
+        if (gain2 > bestGain) {
+            bestGain = gain2;
+            bestGrandChild = otherNode.child2;
+            bestChild = child;
+        }
+    };
+    tryRotations(b, c);
+    tryRotations(c, b);
+    if (bestGrandChild == NULL_NODE) {
+        return;
+    }
+    auto otherChild = bestChild == b ? c : b;
+    auto &otherNode = mNodes[otherChild];
+    if (nodeA.child1 == bestChild) {
+        nodeA.child1 = bestGrandChild;
+    } else {
+        nodeA.child2 = bestGrandChild;
+    }
+    if (otherNode.child1 == bestGrandChild) {
+        otherNode.child1 = bestChild;
+    } else {
+        otherNode.child2 = bestChild;
+    }
+    mNodes[bestGrandChild].parent = a;
+    mNodes[bestChild].parent = otherChild;
+    setUnion(otherNode, mNodes[otherNode.child1], mNodes[otherNode.child2]);
+    otherNode.height = 1 + std::max(mNodes[otherNode.child1].height, mNodes[otherNode.child2].height);
+}
+
+void simple_2d::AabbTree::SetFattenedBox(Node &leaf, const AabbBuffer &boxes, CollisionBodyIndex body) {
+    leaf.minX = boxes.minX[body] - FAT_MARGIN;
+    leaf.minY = boxes.minY[body] - FAT_MARGIN;
+    leaf.maxX = boxes.maxX[body] + FAT_MARGIN;
+    leaf.maxY = boxes.maxY[body] + FAT_MARGIN;
+}
@@ -0,0 +1,27 @@
+#include <simple-2d/collision/broadphase.h>
+#include <simple-2d/collision/aabb_tree.h>
+#include <simple-2d/collision/sweep_and_prune.h>
+#include <simple-2d/collision/spatial_hash.h>
+#include <simple-2d/collision/uniform_grid.h>
+
+void simple_2d::Broadphase::SetFilters(const std::vector<CollisionFilter> *filters) {
+    mFilters = filters;
+}
+
+std::unique_ptr<simple_2d::Broadphase> simple_2d::CreateBroadphase(BroadphaseType type, RectangularDimensions<int> sceneDimensions, uint32_t cellSize) {
+    switch (type) {
+        case AABB_TREE_BROADPHASE:
+            return std::make_unique<AabbTree>();
+        case SWEEP_AND_PRUNE_BROADPHASE:
+            return std::make_unique<SweepAndPrune>();
+        case SPATIAL_HASH_BROADPHASE:
+            // Tunes its own cell size
+            return std::make_unique<SpatialHash>();
+        case UNIFORM_GRID_BROADPHASE:
+        default: {
+            auto grid = std::make_unique<UniformGrid>();
+            grid->SetBounds(sceneDimensions, cellSize);
+            return grid;
+        }
+    }
+}
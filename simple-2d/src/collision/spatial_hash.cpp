@@ -0,0 +1,303 @@
+#include <simple-2d/collision/spatial_hash.h>
+#include <simple-2d/utils.h>
+#include <algorithm>
+#include <cmath>
+
+// Cell coordinates are clamped to this range, so that ranges of cells and their sizes fit in 32 bits
+#define MAX_CELL_COORDINATE (1 << 30)
+
+void simple_2d::SpatialHash::SetCellSize(float cellSize) {
+    mIsTuned = !(cellSize > 0);
+    mCellSize = mIsTuned ? MIN_CELL_SIZE : cellSize;
+    mNumUpdates = 0;
+}
+
+float simple_2d::SpatialHash::GetCellSize() const {
+    return mCellSize;
+}
+
+void simple_2d::SpatialHash::Update(const std::vector<EntityId> &, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) {
+    if (mIsTuned && mNumUpdates % RETUNE_INTERVAL == 0) {
+        Tune(boxes, begin, end);
+    }
+    mNumUpdates++;
+    mFirstBody = begin;
+    mBodyCells.resize(end - begin);
+    mLargeBodies.clear();
+    size_t numEntries = 0;
+    for (auto i = begin; i < end; i++) {
+        auto &cells = mBodyCells[i - begin];
+        cells = GetCellRange(boxes, i);
+        auto numCells = GetNumCells(cells);
+        if (numCells > LARGE_BODY_NUM_CELLS) {
+            mLargeBodies.push_back(i);
+        } else {
+            numEntries += numCells;
+        }
+    }
+    // At least as many buckets as entries. Cells hold about 2 bodies once tuned, so most cells get a bucket of their own.
+    size_t numBuckets = 16;
+    while (numBuckets < numEntries) {
+        numBuckets *= 2;
+    }
+    mBucketMask = uint32_t(numBuckets - 1);
+    // Counting sort of the entries by bucket, one slot to the right so that the prefix sum gives the start of each bucket
+    mBucketStarts.assign(numBuckets + 1, 0);
+    for (auto &cells : mBodyCells) {
+        if (GetNumCells(cells) > LARGE_BODY_NUM_CELLS) {
+            continue;
+        }
+        for (auto y = cells.minY; y <= cells.maxY; y++) {
+            for (auto x = cells.minX; x <= cells.maxX; x++) {
+                mBucketStarts[GetBucket(x, y) + 1]++;
+            }
+        }
+    }
+    for (size_t bucket = 1; bucket <= numBuckets; bucket++) {
+        mBucketStarts[bucket] += mBucketStarts[bucket - 1];
+    }
+    mBucketEntries.resize(numEntries);
+    // Scatter in body order, so the bodies of a cell are sorted by index. mBucketStarts[b] is used as the write cursor of
+    // bucket b, which leaves it at the start of bucket b + 1.
+    for (auto i = begin; i < end; i++) {
+        auto &cells = mBodyCells[i - begin];
+        if (GetNumCells(cells) > LARGE_BODY_NUM_CELLS) {
+            continue;
+        }
+        for (auto y = cells.minY; y <= cells.maxY; y++) {
+            for (auto x = cells.minX; x <= cells.maxX; x++) {
+                mBucketEntries[mBucketStarts[GetBucket(x, y)]++] = {x, y, i};
+            }
+        }
+    }
+    for (size_t bucket = numBuckets; bucket > 0; bucket--) {
+        mBucketStarts[bucket] = mBucketStarts[bucket - 1];
+    }
+    mBucketStarts[0] = 0;
+}
+
+void simple_2d::SpatialHash::FindPairs(std::vector<CollisionPair> &pairs) {
+    auto numBuckets = mBucketStarts.empty() ? 0 : mBucketStarts.size() - 1;
+    for (size_t bucket = 0; bucket < numBuckets; bucket++) {
+        auto begin = mBucketStarts[bucket];
+        auto end = mBucketStarts[bucket + 1];
+        for (auto i = begin; i < end; i++) {
+            auto &entry1 = mBucketEntries[i];
+            auto &cells1 = mBodyCells[entry1.body - mFirstBody];
+            for (auto j = i + 1; j < end; j++) {
+                auto &entry2 = mBucketEntries[j];
+                // Another cell hashed to the same bucket, or bodies whose filters reject each other
+                if (entry1.x != entry2.x || entry1.y != entry2.y || !ShouldCollide(entry1.body, entry2.body)) {
+                    continue;
+                }
+                // Only report the pair in the first cell both bodies cover, so that it is reported once
+                auto &cells2 = mBodyCells[entry2.body - mFirstBody];
+                if (entry1.x == std::max(cells1.minX, cells2.minX) && entry1.y == std::max(cells1.minY, cells2.minY)) {
+                    pairs.push_back({entry1.body, entry2.body});
+                }
+            }
+        }
+    }
+    if (mLargeBodies.empty()) {
+        return;
+    }
+    // Each body tests the large bodies once. Pairs of large bodies are reported from the second one.
+    for (CollisionBodyIndex i = 0; i < mBodyCells.size(); i++) {
+        auto body = mFirstBody + i;
+        auto &cells = mBodyCells[i];
+        for (auto largeBody : mLargeBodies) {
+            if (largeBody >= body) {
+                break;
+            }
+            if (ShouldCollide(largeBody, body) && AreCellRangesOverlap(cells, mBodyCells[largeBody - mFirstBody])) {
+                pairs.push_back({largeBody, body});
+            }
+        }
+        if (GetNumCells(cells) > LARGE_BODY_NUM_CELLS) {
+            continue;
+        }
+        for (auto it = std::upper_bound(mLargeBodies.begin(), mLargeBodies.end(), body); it != mLargeBodies.end(); it++) {
+            if (ShouldCollide(body, *it) && AreCellRangesOverlap(cells, mBodyCells[*it - mFirstBody])) {
+                pairs.push_back({body, *it});
+            }
+        }
+    }
+}
+
+void simple_2d::SpatialHash::FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) {
+    if (mBucketStarts.empty()) {
+        return;
+    }
+    for (auto body2 = begin; body2 < end; body2++) {
+        auto cells2 = GetCellRange(boxes, body2);
+        if (GetNumCells(cells2) > LARGE_BODY_NUM_CELLS) {
+            // Cheaper to test every body of the hash than to walk all the cells of this one
+            for (CollisionBodyIndex i = 0; i < mBodyCells.size(); i++) {
+                if (ShouldCollide(mFirstBody + i, body2) && AreCellRangesOverlap(mBodyCells[i], cells2)) {
+                    pairs.push_back({mFirstBody + i, body2});
+                }
+            }
+            continue;
+        }
+        for (auto y = cells2.minY; y <= cells2.maxY; y++) {
+            for (auto x = cells2.minX; x <= cells2.maxX; x++) {
+                auto bucket = GetBucket(x, y);
+                for (auto i = mBucketStarts[bucket]; i < mBucketStarts[bucket + 1]; i++) {
+                    auto &entry1 = mBucketEntries[i];
+                    if (entry1.x != x || entry1.y != y || !ShouldCollide(entry1.body, body2)) {
+                        continue;
+                    }
+                    auto &cells1 = mBodyCells[entry1.body - mFirstBody];
+                    if (x == std::max(cells1.minX, cells2.minX) && y == std::max(cells1.minY, cells2.minY)) {
+                        pairs.push_back({entry1.body, body2});
+                    }
+                }
+            }
+        }
+        for (auto largeBody : mLargeBodies) {
+            if (ShouldCollide(largeBody, body2) && AreCellRangesOverlap(mBodyCells[largeBody - mFirstBody], cells2)) {
+                pairs.push_back({largeBody, body2});
+            }
+        }
+    }
+}
+
+void simple_2d::SpatialHash::QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) {
+    if (mBucketStarts.empty()) {
+        return;
+    }
+    auto cells2 = GetCellRange(region.top_left.x, region.top_left.y, region.bottom_right.x, region.bottom_right.y);
+    if (GetNumCells(cells2) > std::max(LARGE_BODY_NUM_CELLS, mBodyCells.size())) {
+        for (CollisionBodyIndex i = 0; i < mBodyCells.size(); i++) {
+            if (AreCellRangesOverlap(mBodyCells[i], cells2)) {
+                bodies.push_back(mFirstBody + i);
+            }
+        }
+        return;
+    }
+    for (auto y = cells2.minY; y <= cells2.maxY; y++) {
+        for (auto x = cells2.minX; x <= cells2.maxX; x++) {
+            auto bucket = GetBucket(x, y);
+            for (auto i = mBucketStarts[bucket]; i < mBucketStarts[bucket + 1]; i++) {
+                auto &entry = mBucketEntries[i];
+                if (entry.x != x || entry.y != y) {
+                    continue;
+                }
+                // Only report the body in the first cell it shares with the region
+                auto &cells1 = mBodyCells[entry.body - mFirstBody];
+                if (x == std::max(cells1.minX, cells2.minX) && y == std::max(cells1.minY, cells2.minY)) {
+                    bodies.push_back(entry.body);
+                }
+            }
+        }
+    }
+    for (auto largeBody : mLargeBodies) {
+        if (AreCellRangesOverlap(mBodyCells[largeBody - mFirstBody], cells2)) {
+            bodies.push_back(largeBody);
+        }
+    }
+}
+
+simple_2d::SpatialHashStats simple_2d::SpatialHash::GetStats() const {
+    SpatialHashStats stats;
+    stats.cellSize = mCellSize;
+    stats.numBodies = mBodyCells.size();
+    stats.numCellEntries = mBucketEntries.size();
+    stats.numLargeBodies = mLargeBodies.size();
+    stats.numBuckets = mBucketStarts.empty() ? 0 : mBucketStarts.size() - 1;
+    for (size_t bucket = 0; bucket < stats.numBuckets; bucket++) {
+        auto begin = mBucketStarts[bucket];
+        auto end = mBucketStarts[bucket + 1];
+        size_t numCells = 0;
+        // Entries of a cell are not contiguous when cells share the bucket, so count each cell at its first entry
+        for (auto i = begin; i < end; i++) {
+            auto &entry = mBucketEntries[i];
+            auto isFirst = true;
+            for (auto j = begin; j < i && isFirst; j++) {
+                isFirst = mBucketEntries[j].x != entry.x || mBucketEntries[j].y != entry.y;
+            }
+            if (!isFirst) {
+                continue;
+            }
+            numCells++;
+            uint32_t numBodies = 0;
+            for (auto j = i; j < end; j++) {
+                numBodies += mBucketEntries[j].x == entry.x && mBucketEntries[j].y == entry.y;
+            }
+            stats.maxBodiesPerCell = std::max(stats.maxBodiesPerCell, numBodies);
+        }
+        stats.numOccupiedCells += numCells;
+        stats.numSharedBuckets += numCells > 1;
+    }
+    if (stats.numOccupiedCells > 0) {
+        stats.averageBodiesPerCell = float(stats.numCellEntries) / stats.numOccupiedCells;
+    }
+    if (stats.numBodies > stats.numLargeBodies) {
+        stats.averageCellsPerBody = float(stats.numCellEntries) / (stats.numBodies - stats.numLargeBodies);
+    }
+    return stats;
+}
+
+void simple_2d::SpatialHash::Tune(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) {
+    if (begin == end) {
+        return;
+    }
+    mSizes.clear();
+    for (auto i = begin; i < end; i++) {
+        mSizes.push_back(std::max(boxes.maxX[i] - boxes.minX[i], boxes.maxY[i] - boxes.minY[i]));
+    }
+    auto percentile = mSizes.begin() + size_t(TUNING_PERCENTILE * (mSizes.size() - 1));
+    std::nth_element(mSizes.begin(), percentile, mSizes.end());
+    auto size = *percentile;
+    // Also catches NaN and infinity
+    if (!(size > MIN_CELL_SIZE) || !std::isfinite(size)) {
+        size = MIN_CELL_SIZE;
+    }
+    auto cellSize = std::exp2(std::ceil(std::log2(size)));
+    if (cellSize != mCellSize) {
+        SIMPLE_2D_LOG_DEBUG << "Spatial hash cell size tuned from " << mCellSize << " to " << cellSize << " for " << mSizes.size() << " bodies";
+        mCellSize = cellSize;
+    }
+}
+
+int32_t simple_2d::SpatialHash::GetCellCoordinate(float coordinate) const {
+    auto cell = std::floor(coordinate / mCellSize);
+    // Also catches NaN
+    if (!(cell > -MAX_CELL_COORDINATE)) {
+        return cell < 0 ? -MAX_CELL_COORDINATE : 0;
+    }
+    if (cell > MAX_CELL_COORDINATE) {
+        return MAX_CELL_COORDINATE;
+    }
+    return int32_t(cell);
+}
+
+simple_2d::SpatialHash::CellRange simple_2d::SpatialHash::GetCellRange(const AabbBuffer &boxes, CollisionBodyIndex body) const {
+    return GetCellRange(boxes.minX[body], boxes.minY[body], boxes.maxX[body], boxes.maxY[body]);
+}
+
+simple_2d::SpatialHash::CellRange simple_2d::SpatialHash::GetCellRange(float minX, float minY, float maxX, float maxY) const {
+    CellRange cells;
+    cells.minX = GetCellCoordinate(minX);
+    cells.minY = GetCellCoordinate(minY);
+    cells.maxX = std::max(cells.minX, GetCellCoordinate(maxX));
+    cells.maxY = std::max(cells.minY, GetCellCoordinate(maxY));
+    return cells;
+}
+
+uint32_t simple_2d::SpatialHash::GetBucket(int32_t x, int32_t y) const {
+    // Multiply by large odd constants and mix, so that neighbouring cells land in unrelated buckets
+    auto hash = uint32_t(x) * 0x9e3779b1u ^ uint32_t(y) * 0x85ebca77u;
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    return hash & mBucketMask;
+}
+
+size_t simple_2d::SpatialHash::GetNumCells(const CellRange &cells) {
+    return size_t(int64_t(cells.maxX) - cells.minX + 1) * size_t(int64_t(cells.maxY) - cells.minY + 1);
+}
+
+bool simple_2d::SpatialHash::AreCellRangesOverlap(const CellRange &cells1, const CellRange &cells2) {
+    return cells1.minX <= cells2.maxX && cells2.minX <= cells1.maxX && cells1.minY <= cells2.maxY && cells2.minY <= cells1.maxY;
+}
@@ -0,0 +1,154 @@
+#include <simple-2d/collision/sweep_and_prune.h>
+#include <algorithm>
+
+void simple_2d::SweepAndPrune::Update(const std::vector<EntityId> &entities, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) {
+    mUpdate++;
+    mWideEntries.clear();
+    size_t numNewEntries = 0;
+    for (auto body = begin; body < end; body++) {
+        auto entityId = entities[body];
+        if (boxes.maxX[body] - boxes.minX[body] > WIDE_BODY_WIDTH) {
+            // Its entry in the list, if it had one, is dropped below
+            mWideEntries.push_back({boxes.minX[body], boxes.maxX[body], boxes.minY[body], boxes.maxY[body], entityId, body, mUpdate});
+            continue;
+        }
+        auto entityIndex = GetEntityIndex(entityId);
+        if (entityIndex >= mEntityEntries.size()) {
+            mEntityEntries.resize(entityIndex + 1, NULL_ENTRY);
+        }
+        // The entry of a body dropped by an earlier update may be past the end of the list now
+        auto entry = mEntityEntries[entityIndex];
+        if (entry >= mEntries.size() || mEntries[entry].entityId != entityId) {
+            // New bodies go at the end, the sort moves them to their place
+            entry = uint32_t(mEntries.size());
+            mEntries.push_back({});
+            mEntries[entry].entityId = entityId;
+            mEntityEntries[entityIndex] = entry;
+            numNewEntries++;
+        }
+        auto &current = mEntries[entry];
+        current.minX = boxes.minX[body];
+        current.maxX = boxes.maxX[body];
+        current.minY = boxes.minY[body];
+        current.maxY = boxes.maxY[body];
+        current.body = body;
+        current.lastUpdate = mUpdate;
+    }
+    // Drop the bodies which were not part of this update, keeping the others in order
+    mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(), [this](const Entry &entry) {
+        return entry.lastUpdate != mUpdate;
+    }), mEntries.end());
+    // Insertion sort of the entries kept from the last update: each one only moves past the entries it crossed since then
+    mNumSwaps = 0;
+    auto numOldEntries = mEntries.size() - numNewEntries;
+    for (size_t i = 1; i < numOldEntries; i++) {
+        if (!IsBefore(mEntries[i], mEntries[i - 1])) {
+            continue;
+        }
+        auto entry = mEntries[i];
+        auto j = i;
+        for (; j > 0 && IsBefore(entry, mEntries[j - 1]); j--) {
+            mEntries[j] = mEntries[j - 1];
+        }
+        mEntries[j] = entry;
+        mNumSwaps += i - j;
+    }
+    // The new entries are at the end in no particular order, which would make the insertion sort quadratic when many
+    // bodies appear at once, e.g. when the level is loaded
+    if (numNewEntries > 0) {
+        std::sort(mEntries.begin() + numOldEntries, mEntries.end(), IsBefore);
+        std::inplace_merge(mEntries.begin(), mEntries.begin() + numOldEntries, mEntries.end(), IsBefore);
+    }
+    mMaxWidth = 0;
+    for (uint32_t i = 0; i < mEntries.size(); i++) {
+        auto &entry = mEntries[i];
+        mEntityEntries[GetEntityIndex(entry.entityId)] = i;
+        mMaxWidth = std::max(mMaxWidth, entry.maxX - entry.minX);
+    }
+}
+
+void simple_2d::SweepAndPrune::FindPairs(std::vector<CollisionPair> &pairs) {
+    for (size_t i = 0; i < mEntries.size(); i++) {
+        auto &entry1 = mEntries[i];
+        for (auto j = i + 1; j < mEntries.size() && mEntries[j].minX <= entry1.maxX; j++) {
+            auto &entry2 = mEntries[j];
+            if (ShouldCollide(entry1.body, entry2.body) && entry1.minY <= entry2.maxY && entry2.minY <= entry1.maxY) {
+                pairs.push_back({std::min(entry1.body, entry2.body), std::max(entry1.body, entry2.body)});
+            }
+        }
+    }
+    for (size_t i = 0; i < mWideEntries.size(); i++) {
+        auto &wideEntry = mWideEntries[i];
+        auto it = std::lower_bound(mEntries.begin(), mEntries.end(), wideEntry.minX - mMaxWidth, [](const Entry &entry, float minX) {
+            return entry.minX < minX;
+        });
+        for (; it != mEntries.end() && it->minX <= wideEntry.maxX; it++) {
+            if (ShouldCollide(it->body, wideEntry.body) && wideEntry.minX <= it->maxX && it->minY <= wideEntry.maxY && wideEntry.minY <= it->maxY) {
+                pairs.push_back({std::min(it->body, wideEntry.body), std::max(it->body, wideEntry.body)});
+            }
+        }
+        for (auto j = i + 1; j < mWideEntries.size(); j++) {
+            auto &otherEntry = mWideEntries[j];
+            if (ShouldCollide(wideEntry.body, otherEntry.body) && wideEntry.minX <= otherEntry.maxX && otherEntry.minX <= wideEntry.maxX &&
+                wideEntry.minY <= otherEntry.maxY && otherEntry.minY <= wideEntry.maxY) {
+                pairs.push_back({wideEntry.body, otherEntry.body});
+            }
+        }
+    }
+}
+
+void simple_2d::SweepAndPrune::FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) {
+    for (auto body2 = begin; body2 < end; body2++) {
+        auto start = pairs.size();
+        // No entry starting left of this can reach the box
+        auto firstMinX = boxes.minX[body2] - mMaxWidth;
+        auto it = std::lower_bound(mEntries.begin(), mEntries.end(), firstMinX, [](const Entry &entry, float minX) {
+            return entry.minX < minX;
+        });
+        for (; it != mEntries.end() && it->minX <= boxes.maxX[body2]; it++) {
+            if (ShouldCollide(it->body, body2) && IsOverlapping(*it, boxes, body2)) {
+                pairs.push_back({it->body, body2});
+            }
+        }
+        for (auto &wideEntry : mWideEntries) {
+            if (ShouldCollide(wideEntry.body, body2) && IsOverlapping(wideEntry, boxes, body2)) {
+                pairs.push_back({wideEntry.body, body2});
+            }
+        }
+        std::sort(pairs.begin() + start, pairs.end(), [](const CollisionPair &pair1, const CollisionPair &pair2) {
+            return pair1.first < pair2.first;
+        });
+    }
+}
+
+void simple_2d::SweepAndPrune::QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) {
+    auto isInRegion = [&region](const Entry &entry) {
+        return entry.minX <= region.bottom_right.x && region.top_left.x <= entry.maxX && entry.minY <= region.bottom_right.y && region.top_left.y <= entry.maxY;
+    };
+    auto firstMinX = region.top_left.x - mMaxWidth;
+    auto it = std::lower_bound(mEntries.begin(), mEntries.end(), firstMinX, [](const Entry &entry, float minX) {
+        return entry.minX < minX;
+    });
+    for (; it != mEntries.end() && it->minX <= region.bottom_right.x; it++) {
+        if (isInRegion(*it)) {
+            bodies.push_back(it->body);
+        }
+    }
+    for (auto &wideEntry : mWideEntries) {
+        if (isInRegion(wideEntry)) {
+            bodies.push_back(wideEntry.body);
+        }
+    }
+}
+
+size_t simple_2d::SweepAndPrune::GetNumSwaps() const {
+    return mNumSwaps;
+}
+
+bool simple_2d::SweepAndPrune::IsBefore(const Entry &entry1, const Entry &entry2) {
+    return entry1.minX != entry2.minX ? entry1.minX < entry2.minX : entry1.body < entry2.body;
+}
+
+bool simple_2d::SweepAndPrune::IsOverlapping(const Entry &entry, const AabbBuffer &boxes, CollisionBodyIndex body) {
+    return entry.minX <= boxes.maxX[body] && boxes.minX[body] <= entry.maxX && entry.minY <= boxes.maxY[body] && boxes.minY[body] <= entry.maxY;
+}
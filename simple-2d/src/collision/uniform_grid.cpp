@@ -0,0 +1,227 @@
+#include <simple-2d/collision/uniform_grid.h>
+#include <algorithm>
+#include <cmath>
+
+void simple_2d::UniformGrid::SetBounds(RectangularDimensions<int> sceneDimensions, uint32_t cellSize) {
+    mCellSize = std::max<uint32_t>(1, cellSize);
+    // If the scene dimensions are not a multiple of the cell size, then the last cell will be covered partially
+    mNumCellsX = std::max<uint32_t>(1, (std::max(0, sceneDimensions.width) + mCellSize - 1) / mCellSize);
+    mNumCellsY = std::max<uint32_t>(1, (std::max(0, sceneDimensions.height) + mCellSize - 1) / mCellSize);
+}
+
+void simple_2d::UniformGrid::Build(const AabbBuffer &boxes) {
+    Build(boxes, 0, CollisionBodyIndex(boxes.Size()));
+}
+
+void simple_2d::UniformGrid::Build(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) {
+    auto numCells = size_t(mNumCellsX) * mNumCellsY;
+    mFirstBody = begin;
+    mBodyCells.resize(end - begin);
+    mCellStarts.assign(numCells + 1, 0);
+    mLargeBodies.clear();
+    // Count the bodies of each cell, one slot to the right so that the prefix sum gives the start of each cell
+    for (auto i = begin; i < end; i++) {
+        auto &cells = mBodyCells[i - begin];
+        cells = GetCellRange(boxes, i);
+        if (GetNumCells(cells) > LARGE_BODY_NUM_CELLS) {
+            mLargeBodies.push_back(i);
+            continue;
+        }
+        for (auto y = cells.minY; y <= cells.maxY; y++) {
+            for (auto x = cells.minX; x <= cells.maxX; x++) {
+                mCellStarts[GetCellId(x, y) + 1]++;
+            }
+        }
+    }
+    for (size_t cell = 1; cell <= numCells; cell++) {
+        mCellStarts[cell] += mCellStarts[cell - 1];
+    }
+    mCellBodies.resize(mCellStarts[numCells]);
+    // Scatter in body order, so the bodies of a cell are sorted by index. mCellStarts[c] is used as the write cursor of
+    // cell c, which leaves it at the start of cell c + 1.
+    for (auto i = begin; i < end; i++) {
+        auto &cells = mBodyCells[i - begin];
+        if (GetNumCells(cells) > LARGE_BODY_NUM_CELLS) {
+            continue;
+        }
+        for (auto y = cells.minY; y <= cells.maxY; y++) {
+            for (auto x = cells.minX; x <= cells.maxX; x++) {
+                mCellBodies[mCellStarts[GetCellId(x, y)]++] = i;
+            }
+        }
+    }
+    for (size_t cell = numCells; cell > 0; cell--) {
+        mCellStarts[cell] = mCellStarts[cell - 1];
+    }
+    mCellStarts[0] = 0;
+}
+
+void simple_2d::UniformGrid::Update(const std::vector<EntityId> &, const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end) {
+    Build(boxes, begin, end);
+}
+
+void simple_2d::UniformGrid::FindPairs(std::vector<CollisionPair> &pairs) {
+    auto numCells = mCellStarts.empty() ? 0 : mCellStarts.size() - 1;
+    for (CellId cell = 0; cell < numCells; cell++) {
+        auto begin = mCellStarts[cell];
+        auto end = mCellStarts[cell + 1];
+        for (auto i = begin; i < end; i++) {
+            auto body1 = mCellBodies[i];
+            auto &cells1 = mBodyCells[body1 - mFirstBody];
+            for (auto j = i + 1; j < end; j++) {
+                auto body2 = mCellBodies[j];
+                if (!ShouldCollide(body1, body2)) {
+                    continue;
+                }
+                auto &cells2 = mBodyCells[body2 - mFirstBody];
+                // Only report the pair in the first cell both bodies cover, so that it is reported once
+                auto firstSharedCell = GetCellId(std::max(cells1.minX, cells2.minX), std::max(cells1.minY, cells2.minY));
+                if (firstSharedCell == cell) {
+                    pairs.push_back({body1, body2});
+                }
+            }
+        }
+    }
+    if (mLargeBodies.empty()) {
+        return;
+    }
+    // Each body tests the large bodies once. Pairs of large bodies are reported from the second one.
+    for (CollisionBodyIndex i = 0; i < mBodyCells.size(); i++) {
+        auto body = mFirstBody + i;
+        auto &cells = mBodyCells[i];
+        for (auto largeBody : mLargeBodies) {
+            if (largeBody >= body) {
+                break;
+            }
+            if (ShouldCollide(largeBody, body) && AreCellRangesOverlap(cells, mBodyCells[largeBody - mFirstBody])) {
+                pairs.push_back({largeBody, body});
+            }
+        }
+        if (GetNumCells(cells) > LARGE_BODY_NUM_CELLS) {
+            continue;
+        }
+        for (auto it = std::upper_bound(mLargeBodies.begin(), mLargeBodies.end(), body); it != mLargeBodies.end(); it++) {
+            if (ShouldCollide(body, *it) && AreCellRangesOverlap(cells, mBodyCells[*it - mFirstBody])) {
+                pairs.push_back({body, *it});
+            }
+        }
+    }
+}
+
+void simple_2d::UniformGrid::FindPairsWith(const AabbBuffer &boxes, CollisionBodyIndex begin, CollisionBodyIndex end, std::vector<CollisionPair> &pairs) {
+    if (mCellStarts.empty()) {
+        return;
+    }
+    for (auto body2 = begin; body2 < end; body2++) {
+        auto cells2 = GetCellRange(boxes, body2);
+        if (GetNumCells(cells2) > LARGE_BODY_NUM_CELLS) {
+            // Cheaper to test every body of the grid than to walk all the cells of this one
+            for (CollisionBodyIndex i = 0; i < mBodyCells.size(); i++) {
+                if (ShouldCollide(mFirstBody + i, body2) && AreCellRangesOverlap(mBodyCells[i], cells2)) {
+                    pairs.push_back({mFirstBody + i, body2});
+                }
+            }
+            continue;
+        }
+        for (auto y = cells2.minY; y <= cells2.maxY; y++) {
+            for (auto x = cells2.minX; x <= cells2.maxX; x++) {
+                auto cell = GetCellId(x, y);
+                for (auto i = mCellStarts[cell]; i < mCellStarts[cell + 1]; i++) {
+                    auto body1 = mCellBodies[i];
+                    if (!ShouldCollide(body1, body2)) {
+                        continue;
+                    }
+                    auto &cells1 = mBodyCells[body1 - mFirstBody];
+                    if (GetCellId(std::max(cells1.minX, cells2.minX), std::max(cells1.minY, cells2.minY)) == cell) {
+                        pairs.push_back({body1, body2});
+                    }
+                }
+            }
+        }
+        for (auto largeBody : mLargeBodies) {
+            if (ShouldCollide(largeBody, body2) && AreCellRangesOverlap(mBodyCells[largeBody - mFirstBody], cells2)) {
+                pairs.push_back({largeBody, body2});
+            }
+        }
+    }
+}
+
+void simple_2d::UniformGrid::QueryRegion(const Rectangle<float> &region, std::vector<CollisionBodyIndex> &bodies) {
+    if (mCellStarts.empty()) {
+        return;
+    }
+    auto cells2 = GetCellRange(region.top_left.x, region.top_left.y, region.bottom_right.x, region.bottom_right.y);
+    if (GetNumCells(cells2) > std::max(LARGE_BODY_NUM_CELLS, mBodyCells.size())) {
+        for (CollisionBodyIndex i = 0; i < mBodyCells.size(); i++) {
+            if (AreCellRangesOverlap(mBodyCells[i], cells2)) {
+                bodies.push_back(mFirstBody + i);
+            }
+        }
+        return;
+    }
+    for (auto y = cells2.minY; y <= cells2.maxY; y++) {
+        for (auto x = cells2.minX; x <= cells2.maxX; x++) {
+            auto cell = GetCellId(x, y);
+            for (auto i = mCellStarts[cell]; i < mCellStarts[cell + 1]; i++) {
+                auto body = mCellBodies[i];
+                // Only report the body in the first cell it shares with the region
+                auto &cells1 = mBodyCells[body - mFirstBody];
+                if (GetCellId(std::max(cells1.minX, cells2.minX), std::max(cells1.minY, cells2.minY)) == cell) {
+                    bodies.push_back(body);
+                }
+            }
+        }
+    }
+    for (auto largeBody : mLargeBodies) {
+        if (AreCellRangesOverlap(mBodyCells[largeBody - mFirstBody], cells2)) {
+            bodies.push_back(largeBody);
+        }
+    }
+}
+
+uint32_t simple_2d::UniformGrid::GetNumCellsX() const {
+    return mNumCellsX;
+}
+
+uint32_t simple_2d::UniformGrid::GetNumCellsY() const {
+    return mNumCellsY;
+}
+
+uint32_t simple_2d::UniformGrid::GetCellCoordinate(float coordinate, uint32_t numCells) const {
+    auto cell = std::floor(coordinate / mCellSize);
+    // Also catches NaN
+    if (!(cell > 0)) {
+        return 0;
+    }
+    if (cell >= float(numCells - 1)) {
+        return numCells - 1;
+    }
+    return uint32_t(cell);
+}
+
+simple_2d::UniformGrid::CellRange simple_2d::UniformGrid::GetCellRange(const AabbBuffer &boxes, CollisionBodyIndex body) const {
+    return GetCellRange(boxes.minX[body], boxes.minY[body], boxes.maxX[body], boxes.maxY[body]);
+}
+
+simple_2d::UniformGrid::CellRange simple_2d::UniformGrid::GetCellRange(float minX, float minY, float maxX, float maxY) const {
+    CellRange cells;
+    cells.minX = GetCellCoordinate(minX, mNumCellsX);
+    cells.minY = GetCellCoordinate(minY, mNumCellsY);
+    cells.maxX = GetCellCoordinate(maxX, mNumCellsX);
+    cells.maxY = GetCellCoordinate(maxY, mNumCellsY);
+    return cells;
+}
+
+simple_2d::UniformGrid::CellId simple_2d::UniformGrid::GetCellId(uint32_t x, uint32_t y) const {
+    // The cell id is the index of the cell in the grid, which top left cell is 0,
+    // below top left cell is mNumCellsX and below it is mNumCellsX * 2, etc.
+    return y * mNumCellsX + x;
+}
+
+size_t simple_2d::UniformGrid::GetNumCells(const CellRange &cells) {
+    return size_t(cells.maxX - cells.minX + 1) * size_t(cells.maxY - cells.minY + 1);
+}
+
+bool simple_2d::UniformGrid::AreCellRangesOverlap(const CellRange &cells1, const CellRange &cells2) {
+    return cells1.minX <= cells2.maxX && cells2.minX <= cells1.maxX && cells1.minY <= cells2.maxY && cells2.minY <= cells1.maxY;
+}
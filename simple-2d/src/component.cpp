@@ -1,13 +1,7 @@
 #include <simple-2d/component.h>
 #include <simple-2d/utils.h>
-#include <simple-2d/components/animated_sprite.h>
-#include <simple-2d/components/motion.h>
-#include <simple-2d/components/downward_gravity.h>
-#include <simple-2d/components/static_sprite.h>
-#include <simple-2d/components/json.h>
-#include <simple-2d/components/behavior_script.h>
-#include <simple-2d/components/static_repetitive_sprite.h>
-#include <simple-2d/components/collision_body.h>
+#include <simple-2d/scene.h>
+#include <simple-2d/core.h>
 
 simple_2d::ComponentManager::ComponentManager() {
     SIMPLE_2D_LOG_DEBUG << "ComponentManager constructor " << this;
@@ -26,34 +20,64 @@ std::string simple_2d::ComponentManager::GetName() {
     return mComponentManagerName;
 }
 
+void simple_2d::ComponentManager::SetComponentAccess(ComponentAccess componentAccess) {
+    mComponentAccess = componentAccess;
+}
+
+const simple_2d::ComponentAccess& simple_2d::ComponentManager::GetComponentAccess() const {
+    return mComponentAccess;
+}
+
+void simple_2d::ComponentManager::SetScene(Scene *scene, ComponentType componentType) {
+    mScene = scene;
+    mComponentType = componentType;
+}
+
+simple_2d::Scene* simple_2d::ComponentManager::GetScene() const {
+    return mScene;
+}
+
+simple_2d::ComponentType simple_2d::ComponentManager::GetComponentType() const {
+    return mComponentType;
+}
+
+simple_2d::WorkerPool& simple_2d::ComponentManager::GetWorkerPool() const {
+    return Engine::GetInstance().GetWorkerPool();
+}
+
+void simple_2d::ComponentManager::NotifyComponentAdded(EntityId id) {
+    if (mScene != nullptr) {
+        mScene->SetComponentBit(id, mComponentType, true);
+    }
+}
+
+void simple_2d::ComponentManager::NotifyComponentRemoved(EntityId id) {
+    if (mScene != nullptr) {
+        mScene->SetComponentBit(id, mComponentType, false);
+    }
+}
+
 void simple_2d::ComponentManager::Step() {
     SIMPLE_2D_LOG_INFO << "Stepping component manager \"" << mComponentManagerName << "\"";
+    mIsStepping = true;
     DoStep();
+    mIsStepping = false;
+    for (auto id : mPendingRemovals) {
+        RemoveComponentOfEntity(id);
+    }
+    mPendingRemovals.clear();
 }
 
-std::shared_ptr<simple_2d::Component> simple_2d::Component::CreateComponent(ComponentType componentType, EntityId entityId) {
-    switch (componentType)
-    {
-    case ANIMATED_SPITE:
-        return std::make_shared<simple_2d::AnimatedSprite>(entityId);
-    case BEHAVIOR_SCRIPT:
-        return std::make_shared<simple_2d::BehaviorScript>(entityId);
-    case COLLISION_BODY:
-        return std::make_shared<simple_2d::CollisionBodyComponent>(entityId);
-    case DOWNWARD_GRAVITY:
-        return std::make_shared<simple_2d::DownwardGravity>(entityId);
-    case STATIC_SPRITE:
-        return std::make_shared<simple_2d::StaticSpriteComponent>(entityId);
-    case STATIC_REPETITIVE_SPRITE:
-        return std::make_shared<simple_2d::StaticRepetitiveSpriteComponent>(entityId);
-    case MOTION:
-        return std::make_shared<simple_2d::MotionComponent>(entityId);
-    case JSON:
-        return std::make_shared<simple_2d::JsonComponent>(entityId);
-    default:
-        SIMPLE_2D_LOG_ERROR << "Component type " << componentType << " not supported!";
-        return nullptr;
+void simple_2d::ComponentManager::RemoveComponentOfEntity(EntityId id) {
+    if (mIsStepping) {
+        mPendingRemovals.push_back(id);
+        return;
     }
+    if (!EraseComponent(id)) {
+        SIMPLE_2D_LOG_WARNING << "Cannot delete component \"" << mComponentManagerName << "\" for entity " << id << " because component not exist";
+        return;
+    }
+    NotifyComponentRemoved(id);
 }
 
 void simple_2d::Component::SetEntityId(EntityId id) {
@@ -68,25 +92,3 @@ void simple_2d::Component::SetEntityId(EntityId id) {
 simple_2d::EntityId simple_2d::Component::GetEntityId() const {
     return mEntityId;
 }
-
-void simple_2d::ComponentManager::RegisterNewEntity(simple_2d::EntityId id, std::shared_ptr<Component> component) {
-    mComponents[id] = component;
-}
-
-std::shared_ptr<simple_2d::Component> simple_2d::ComponentManager::GetComponent(EntityId id) const {
-    auto it = mComponents.find(id);
-    if (it == mComponents.end()) {
-        SIMPLE_2D_LOG_ERROR << "Not found component \"" << mComponentManagerName << "\" for entity " << id;
-        return nullptr;
-    }
-    return it->second;
-}
-
-void simple_2d::ComponentManager::RemoveComponentOfEntity(EntityId id) {
-    auto it = mComponents.find(id);
-    if (it == mComponents.end()) {
-        SIMPLE_2D_LOG_WARNING << "Cannot delete component \"" << mComponentManagerName << "\" for entity " << id << " because component not exist";
-        return;
-    }
-    mComponents.erase(it);
-}
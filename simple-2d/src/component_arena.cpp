@@ -0,0 +1,60 @@
+#include <simple-2d/component_arena.h>
+#include <simple-2d/utils.h>
+#include <algorithm>
+
+void* simple_2d::ComponentArena::AllocatePage(size_t statsSlot, size_t size, size_t alignment) {
+    auto &stats = GetMutableStats(statsSlot);
+    stats.pageBytes += size;
+    stats.peakPageBytes = std::max(stats.peakPageBytes, stats.pageBytes);
+    auto freePages = mFreePages.find(size);
+    if (freePages != mFreePages.end() && !freePages->second.empty()) {
+        auto page = freePages->second.back();
+        freePages->second.pop_back();
+        return page;
+    }
+    auto padding = (alignment - reinterpret_cast<uintptr_t>(mCursor) % alignment) % alignment;
+    if (mCursor == nullptr || padding + size > mBytesLeftInBlock) {
+        // The rest of the current block is wasted. It is small compared to the block as long as pages are much smaller.
+        auto blockSize = std::max(BLOCK_SIZE, size);
+        // Not value-initialized: components are constructed in place anyway
+        mBlocks.push_back(std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]));
+        mReservedBytes += blockSize;
+        mCursor = mBlocks.back().get();
+        mBytesLeftInBlock = blockSize;
+        padding = 0;
+        SIMPLE_2D_LOG_DEBUG << "Component arena grows to " << mReservedBytes << " bytes";
+    }
+    auto page = mCursor + padding;
+    mCursor += padding + size;
+    mBytesLeftInBlock -= padding + size;
+    return page;
+}
+
+void simple_2d::ComponentArena::FreePage(size_t statsSlot, void *page, size_t size) {
+    GetMutableStats(statsSlot).pageBytes -= size;
+    mFreePages[size].push_back(page);
+}
+
+void simple_2d::ComponentArena::TrackLiveBytes(size_t statsSlot, ptrdiff_t bytes) {
+    auto &stats = GetMutableStats(statsSlot);
+    stats.liveBytes += bytes;
+    stats.peakLiveBytes = std::max(stats.peakLiveBytes, stats.liveBytes);
+}
+
+simple_2d::ComponentMemoryStats simple_2d::ComponentArena::GetStats(size_t statsSlot) const {
+    if (statsSlot >= mStats.size()) {
+        return ComponentMemoryStats();
+    }
+    return mStats[statsSlot];
+}
+
+size_t simple_2d::ComponentArena::GetReservedBytes() const {
+    return mReservedBytes;
+}
+
+simple_2d::ComponentMemoryStats& simple_2d::ComponentArena::GetMutableStats(size_t statsSlot) {
+    if (statsSlot >= mStats.size()) {
+        mStats.resize(statsSlot + 1);
+    }
+    return mStats[statsSlot];
+}
@@ -24,8 +24,13 @@ simple_2d::Error simple_2d::AnimatedSprite::PlayAnimation(AnimationId animation_
 }
 
 simple_2d::Error simple_2d::AnimatedSprite::Step() {
-    auto err = RenderCurrentFrame();
-    if (Error::OK != RenderCurrentFrame()) {
+    auto motion = mMotion.Get();
+    if (motion == nullptr) {
+        SIMPLE_2D_LOG_ERROR << "Failed to get motion component";
+        return Error::NOT_EXISTS;
+    }
+    auto err = RenderCurrentFrame(*motion);
+    if (Error::OK != err) {
         SIMPLE_2D_LOG_ERROR << "Failed to render current frame";
         return err;
     }
@@ -37,29 +42,18 @@ simple_2d::Error simple_2d::AnimatedSprite::Step() {
     return Error::OK;
 }
 
-simple_2d::Error simple_2d::AnimatedSprite::RenderCurrentFrame() const {
+simple_2d::Error simple_2d::AnimatedSprite::RenderCurrentFrame(const MotionComponent &motion) const {
     if (mAnimationTree.find(mStatus.animation_id) == mAnimationTree.end()) {
         SIMPLE_2D_LOG_ERROR << "Animation not found";
         return Error::NOT_EXISTS;
     }
-    auto animation = mAnimationTree.at(mStatus.animation_id);
+    const auto &animation = mAnimationTree.at(mStatus.animation_id);
     if (mStatus.frame_id >= animation.size()) {
         SIMPLE_2D_LOG_ERROR << "Frame id out of bounds";
         return Error::NOT_EXISTS;
     }
     auto frame = animation.at(mStatus.frame_id).texture;
-    auto componentManager = simple_2d::Engine::GetInstance().GetComponentManager(ComponentType::MOTION);
-    if (componentManager == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
-        return Error::NOT_EXISTS;
-    }
-    auto component = componentManager->GetComponent(mEntityId);
-    if (component == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component";
-        return Error::NOT_EXISTS;
-    }
-    auto motionComponent = std::static_pointer_cast<MotionComponent>(component);
-    auto position = motionComponent->GetPosition() + mOffset;
+    auto position = motion.GetPosition() + mOffset;
     Engine::GetInstance().PrepareTextureForRendering(frame, position);
     return Error::OK;
 }
@@ -90,11 +84,19 @@ simple_2d::XYCoordinate<float> simple_2d::AnimatedSprite::GetOffset() const {
 
 simple_2d::AnimatedSpriteComponentManager::AnimatedSpriteComponentManager() {
     SetName("animated_sprite");
+    SetComponentAccess({
+        .reads = GetComponentBit(ANIMATED_SPITE) | GetComponentBit(MOTION),
+        .writes = GetComponentBit(ANIMATED_SPITE),
+        .resources = RENDER_RESOURCE,
+    });
 }
 
 void simple_2d::AnimatedSpriteComponentManager::DoStep() {
-    for (auto &component : mComponents) {
-        auto animatedSprite = std::static_pointer_cast<AnimatedSprite>(component.second);
-        animatedSprite->Step();
+    for (auto &animatedSprite : mComponents) {
+        animatedSprite.Step();
     }
 }
+
+void simple_2d::AnimatedSpriteComponentManager::BindComponent(AnimatedSprite &animatedSprite) {
+    animatedSprite.BindMotion(&mScene->GetComponentManager<MotionComponent>()->GetStorage());
+}
@@ -40,11 +40,12 @@ simple_2d::Error simple_2d::BehaviorScript::Step() {
 
 simple_2d::BehaviorScriptComponentManager::BehaviorScriptComponentManager() {
     SetName("behavior_script");
+    // Scripts run game code, which may do anything
+    SetComponentAccess({.isExclusive = true});
 }
 
 void simple_2d::BehaviorScriptComponentManager::DoStep() {
-    for (auto &component : mComponents) {
-        auto behaviorScript = std::static_pointer_cast<BehaviorScript>(component.second);
-        behaviorScript->Step();
+    for (auto &behaviorScript : mComponents) {
+        behaviorScript.Step();
     }
 }
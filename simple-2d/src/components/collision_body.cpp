@@ -3,8 +3,21 @@
 #include <simple-2d/components/motion.h>
 #include <simple-2d/utils.h>
 #include <simple-2d/components/config.h>
+#include <algorithm>
 #include <cmath>
-#include <array>
+#include <limits>
+
+// Candidate pairs per task of the detect phase
+#define DETECT_CHUNK_SIZE 512
+// A dynamic body is at rest while its speed next tick stays under SLEEP_SPEED pixels per tick, and goes to sleep with its
+// island after SLEEP_TICKS ticks at rest
+#define SLEEP_SPEED 0.01f
+#define SLEEP_TICKS 60
+// Raycasts query the broadphases one piece of the ray at a time, so that a long diagonal ray does not query a region as
+// large as its bounding box, and stop at the first piece with a hit
+#define RAYCAST_PIECE_LENGTH CELL_SIZE
+// Half the size of the first square searched by QueryNearest, doubled until it holds enough bodies
+#define NEAREST_QUERY_HALF_SIZE (CELL_SIZE / 2)
 
 simple_2d::CollisionBodyComponent::CollisionBodyComponent(EntityId entityId) {
     mEntityId = entityId;
@@ -12,7 +25,12 @@ simple_2d::CollisionBodyComponent::CollisionBodyComponent(EntityId entityId) {
 
 
 void simple_2d::CollisionBodyComponent::SetEnabled(bool enabled) {
+    // Setting the current value again must not rebuild the static bodies, scripts may do it every tick
+    if (mIsEnabled == enabled) {
+        return;
+    }
     mIsEnabled = enabled;
+    NotifyStaticBodyChanged();
 }
 
 bool simple_2d::CollisionBodyComponent::IsEnabled() const {
@@ -20,7 +38,11 @@ bool simple_2d::CollisionBodyComponent::IsEnabled() const {
 }
 
 void simple_2d::CollisionBodyComponent::SetSize(RectangularDimensions<float> size) {
+    if (mSize.width == size.width && mSize.height == size.height) {
+        return;
+    }
     mSize = size;
+    NotifyStaticBodyChanged();
 }
 
 simple_2d::RectangularDimensions<float> simple_2d::CollisionBodyComponent::GetSize() const {
@@ -28,20 +50,97 @@ simple_2d::RectangularDimensions<float> simple_2d::CollisionBodyComponent::GetSi
 }
 
 void simple_2d::CollisionBodyComponent::SetOffset(XYCoordinate<float> offset) {
+    if (mOffset.x == offset.x && mOffset.y == offset.y) {
+        return;
+    }
     mOffset = offset;
+    NotifyStaticBodyChanged();
 }
 
 simple_2d::XYCoordinate<float> simple_2d::CollisionBodyComponent::GetOffset() const {
     return mOffset;
 }
 
-std::pair<simple_2d::Error, simple_2d::Rectangle<float>> simple_2d::CollisionBodyComponent::GetCollisionBox() const {
-    auto motionComponentManager = Engine::GetInstance().GetComponentManager(ComponentType::MOTION);
-    if (motionComponentManager == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
-        return {Error::NOT_EXISTS, Rectangle<float>()};
+void simple_2d::CollisionBodyComponent::SetBodyType(BodyType bodyType) {
+    if (mBodyType == bodyType) {
+        return;
+    }
+    // Leaving the static structure also requires a rebuild
+    NotifyStaticBodyChanged();
+    mBodyType = bodyType;
+    NotifyStaticBodyChanged();
+}
+
+simple_2d::CollisionBodyComponent::BodyType simple_2d::CollisionBodyComponent::GetBodyType() const {
+    return mBodyType;
+}
+
+void simple_2d::CollisionBodyComponent::SetCategoryBits(uint32_t categoryBits) {
+    if (mFilter.categoryBits == categoryBits) {
+        return;
+    }
+    mFilter.categoryBits = categoryBits;
+    NotifyStaticBodyChanged();
+}
+
+uint32_t simple_2d::CollisionBodyComponent::GetCategoryBits() const {
+    return mFilter.categoryBits;
+}
+
+void simple_2d::CollisionBodyComponent::SetMaskBits(uint32_t maskBits) {
+    if (mFilter.maskBits == maskBits) {
+        return;
     }
-    auto motionComponent = std::static_pointer_cast<MotionComponent>(motionComponentManager->GetComponent(GetEntityId()));
+    mFilter.maskBits = maskBits;
+    NotifyStaticBodyChanged();
+}
+
+uint32_t simple_2d::CollisionBodyComponent::GetMaskBits() const {
+    return mFilter.maskBits;
+}
+
+simple_2d::CollisionFilter simple_2d::CollisionBodyComponent::GetCollisionFilter() const {
+    return mFilter;
+}
+
+void simple_2d::CollisionBodyComponent::SetSensor(bool isSensor) {
+    if (mIsSensor == isSensor) {
+        return;
+    }
+    mIsSensor = isSensor;
+    NotifyStaticBodyChanged();
+}
+
+bool simple_2d::CollisionBodyComponent::IsSensor() const {
+    return mIsSensor;
+}
+
+void simple_2d::CollisionBodyComponent::SetSleepingAllowed(bool isSleepingAllowed) {
+    if (mIsSleepingAllowed == isSleepingAllowed) {
+        return;
+    }
+    mIsSleepingAllowed = isSleepingAllowed;
+    mRestTicks = 0;
+    NotifyStaticBodyChanged();
+}
+
+bool simple_2d::CollisionBodyComponent::IsSleepingAllowed() const {
+    return mIsSleepingAllowed;
+}
+
+void simple_2d::CollisionBodyComponent::NotifyStaticBodyChanged() {
+    if (mBodyType != Dynamic && mManager != nullptr) {
+        mManager->MarkStaticBodiesDirty();
+    }
+    // The manager notices it at the next step, and wakes up its island too
+    auto motionComponent = mMotion.Get();
+    if (motionComponent != nullptr && !motionComponent->IsAwake()) {
+        motionComponent->WakeUp();
+    }
+}
+
+std::pair<simple_2d::Error, simple_2d::Rectangle<float>> simple_2d::CollisionBodyComponent::GetCollisionBox() const {
+    auto motionComponent = mMotion.Get();
     if (motionComponent == nullptr) {
         SIMPLE_2D_LOG_ERROR << "Failed to get motion component";
         return {Error::NOT_EXISTS, Rectangle<float>()};
@@ -53,12 +152,7 @@ std::pair<simple_2d::Error, simple_2d::Rectangle<float>> simple_2d::CollisionBod
 }
 
 std::pair<simple_2d::Error, simple_2d::Rectangle<float>> simple_2d::CollisionBodyComponent::GetCollisionBoxNextTick() const {
-    auto motionComponentManager = Engine::GetInstance().GetComponentManager(ComponentType::MOTION);
-    if (motionComponentManager == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
-        return {Error::NOT_EXISTS, Rectangle<float>()};
-    }
-    auto motionComponent = std::static_pointer_cast<MotionComponent>(motionComponentManager->GetComponent(GetEntityId()));
+    auto motionComponent = mMotion.Get();
     if (motionComponent == nullptr) {
         SIMPLE_2D_LOG_ERROR << "Failed to get motion component";
         return {Error::NOT_EXISTS, Rectangle<float>()};
@@ -79,6 +173,56 @@ void simple_2d::CollisionBodyComponent::NotifyCollision(EntityId otherEntityId,
     }
 }
 
+void simple_2d::CollisionBodyComponent::SetOnCollisionEnterCallback(OnCollisionCallback callback) {
+    mOnCollisionEnterCallback = callback;
+}
+
+void simple_2d::CollisionBodyComponent::SetOnCollisionStayCallback(OnCollisionCallback callback) {
+    mOnCollisionStayCallback = callback;
+}
+
+void simple_2d::CollisionBodyComponent::SetOnCollisionExitCallback(OnCollisionExitCallback callback) {
+    mOnCollisionExitCallback = callback;
+}
+
+void simple_2d::CollisionBodyComponent::NotifyCollisionEnter(EntityId otherEntityId, CollisionType collisionType) {
+    if (mOnCollisionEnterCallback) {
+        mOnCollisionEnterCallback(GetEntityId(), otherEntityId, collisionType);
+    }
+}
+
+void simple_2d::CollisionBodyComponent::NotifyCollisionStay(EntityId otherEntityId, CollisionType collisionType) {
+    if (mOnCollisionStayCallback) {
+        mOnCollisionStayCallback(GetEntityId(), otherEntityId, collisionType);
+    }
+}
+
+void simple_2d::CollisionBodyComponent::NotifyCollisionExit(EntityId otherEntityId) {
+    if (mOnCollisionExitCallback) {
+        mOnCollisionExitCallback(GetEntityId(), otherEntityId);
+    }
+}
+
+void simple_2d::CollisionBodyComponent::SetOnOverlapEnterCallback(OnOverlapCallback callback) {
+    mOnOverlapEnterCallback = callback;
+}
+
+void simple_2d::CollisionBodyComponent::SetOnOverlapExitCallback(OnOverlapCallback callback) {
+    mOnOverlapExitCallback = callback;
+}
+
+void simple_2d::CollisionBodyComponent::NotifyOverlapEnter(EntityId otherEntityId) {
+    if (mOnOverlapEnterCallback) {
+        mOnOverlapEnterCallback(GetEntityId(), otherEntityId);
+    }
+}
+
+void simple_2d::CollisionBodyComponent::NotifyOverlapExit(EntityId otherEntityId) {
+    if (mOnOverlapExitCallback) {
+        mOnOverlapExitCallback(GetEntityId(), otherEntityId);
+    }
+}
+
 simple_2d::Error simple_2d::CollisionBodyComponent::Step() {
     // Do nothing since callback handles collision
     return Error::OK;
@@ -86,434 +230,882 @@ simple_2d::Error simple_2d::CollisionBodyComponent::Step() {
 
 simple_2d::CollisionBodyComponentManager::CollisionBodyComponentManager() {
     SetName("collision_body");
-    // Because component manager are part of the scene, we can guarantee that current scene is not null
-    auto sceneDimensions = Engine::GetInstance().GetCurrentScene()->GetDimensions();
-    // Calculate the number of cells in the x and y directions
-    // If the scene dimensions are not a multiple of CELL_SIZE, then the last cell will be covered partially
-    if (sceneDimensions.width % CELL_SIZE == 0) {
-        mNumCellsX = sceneDimensions.width / CELL_SIZE;
-    } else {
-        mNumCellsX = sceneDimensions.width / CELL_SIZE + 1;
-    }
-}
-
-simple_2d::CollisionBodyComponentManager::CollisionCellId simple_2d::CollisionBodyComponentManager::GetCollisionCellId(XYCoordinate<CollisionCellId> cellIdPosition) {
-    // The cell id is the index of the cell in the grid, which top left cell is 0,
-    // below top left cell is mNumCellsX and below it is mNumCellsX * 2, etc.
-    return cellIdPosition.y * mNumCellsX + cellIdPosition.x;
+    // Collision callbacks run game code, which may do anything
+    SetComponentAccess({.isExclusive = true});
+    SetBroadphaseType(UNIFORM_GRID_BROADPHASE);
 }
 
-
 void simple_2d::CollisionBodyComponentManager::DoStep() {
-    // Update the collision cell entities map
-    mCollisionCellEntitiesMap.clear();
-    for (auto &component : mComponents) {
-        auto collisionBodyComponent = std::static_pointer_cast<CollisionBodyComponent>(component.second);
-        if (!collisionBodyComponent->IsEnabled()) {
-            SIMPLE_2D_LOG_DEBUG << "Collision body component is not enabled for entity " << collisionBodyComponent->GetEntityId();
+    mTick++;
+    // Sleeping bodies woken up since the last step, by MotionComponent or a change to their collision body. Looked up
+    // again since bodies may have been added or removed, and a removed body wakes up the rest of its island.
+    for (size_t i = 0; i < mSleepingBodies.size(); i++) {
+        auto collisionBodyComponent = mComponents.Find(mBodyEntities[mSleepingBodies[i]]);
+        if (collisionBodyComponent == nullptr) {
+            mWokenIslands.push_back(mSleepingIslandIds[i]);
             continue;
         }
-        auto motionComponentManager = Engine::GetInstance().GetComponentManager(ComponentType::MOTION);
-        if (motionComponentManager == nullptr) {
-            SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
+        auto motionComponent = collisionBodyComponent->GetMotion();
+        if (motionComponent == nullptr || motionComponent->IsAwake()) {
+            mWokenIslands.push_back(collisionBodyComponent->mIslandId);
+        }
+    }
+    WakeIslands();
+    // Static bodies stay at the front of the snapshot, and in their own broadphase, until one of them changes. Erasing a
+    // component moves another one, which changes the version of the storage.
+    if (mAreStaticBodiesDirty || mStaticBodiesStorageVersion != mComponents.GetVersion()) {
+        RebuildStaticBodies();
+    }
+    // Snapshot the other enabled bodies and their collision boxes
+    mBodyEntities.resize(mNumStaticBodies);
+    mBodyComponents.resize(mNumStaticBodies);
+    mBodyTypes.resize(mNumStaticBodies);
+    mBodyFilters.resize(mNumStaticBodies);
+    mBodyIsSensor.resize(mNumStaticBodies);
+    mBodyBoxes.Resize(mNumStaticBodies);
+    mBodySweptBoxes.Resize(mNumStaticBodies);
+    mBodyBoxesNextTick.Resize(mNumStaticBodies);
+    mScene->View<CollisionBodyComponent, MotionComponent>().ForEach([this](EntityId entityId, CollisionBodyComponent &collisionBodyComponent, MotionComponent &motion) {
+        if (!collisionBodyComponent.IsEnabled()) {
+            SIMPLE_2D_LOG_DEBUG << "Collision body component is not enabled for entity " << entityId;
+            return;
+        }
+        if (collisionBodyComponent.GetBodyType() == CollisionBodyComponent::Static || !motion.IsAwake()) {
+            return;
+        }
+        AddBodyToSnapshot(entityId, collisionBodyComponent, motion);
+    });
+    auto numBodies = CollisionBodyIndex(mBodyEntities.size());
+    // Moving bodies against each other, then against the static ones
+    mBroadphase->Update(mBodyEntities, mBodySweptBoxes, mNumStaticBodies, numBodies);
+    mCandidatePairs.clear();
+    mBroadphase->FindPairs(mCandidatePairs);
+    mStaticBroadphase->FindPairsWith(mBodySweptBoxes, mNumStaticBodies, numBodies, mCandidatePairs);
+    // Detect phase: each candidate pair is classified from the snapshot alone, so chunks of pairs run on any thread and
+    // the results do not depend on the number of threads
+    mDetectedPairs.resize(mCandidatePairs.size());
+    GetWorkerPool().ParallelFor(mCandidatePairs.size(), [this](size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++) {
+            mDetectedPairs[i] = DetectPair(mCandidatePairs[i].first, mCandidatePairs[i].second);
+        }
+    }, {.chunkSize = DETECT_CHUNK_SIZE});
+    // Resolve phase, on this thread in the order of the pairs, which only depends on the bodies
+    mIsBodyMoved.assign(numBodies, false);
+    mIsBodyEscaped.assign(numBodies, false);
+    mEscapedBodies.clear();
+    mCollidingPairs.clear();
+    mSensorPairs.clear();
+    for (size_t pair = 0; pair < mCandidatePairs.size(); pair++) {
+        auto [body1, body2] = mCandidatePairs[pair];
+        auto entityId1 = mBodyEntities[body1];
+        auto entityId2 = mBodyEntities[body2];
+        auto detectedPair = mDetectedPairs[pair];
+        // A body moved by an earlier pair of this tick makes what was detected from the snapshot stale
+        auto isSwept = detectedPair.status == PAIR_SEPARATE || detectedPair.status == PAIR_COLLIDING;
+        if (isSwept && (mIsBodyMoved[body1] || mIsBodyMoved[body2])) {
+            detectedPair = DetectPair(body1, body2);
+        }
+        // A body moving into a sleeping one wakes up its island. The sleeping body does not move until the next tick.
+        auto isSleeping1 = IsBodySleeping(body1);
+        auto isSleeping2 = IsBodySleeping(body2);
+        if (isSleeping1 || isSleeping2) {
+            auto otherBody = isSleeping1 ? body2 : body1;
+            // Kinematic bodies are not checked against static ones, so a moving kinematic body wakes up the sleeping ones
+            // it touches during the tick, including those resting on it as it moves away
+            auto isKinematicMoving = mBodyTypes[otherBody] == CollisionBodyComponent::Kinematic &&
+                                     (mBodyBoxes.minX[otherBody] != mBodyBoxesNextTick.minX[otherBody] || mBodyBoxes.minY[otherBody] != mBodyBoxesNextTick.minY[otherBody]);
+            auto isTouching = detectedPair.status == PAIR_COLLIDING ||
+                              (isKinematicMoving && !mBodyIsSensor[body1] && !mBodyIsSensor[body2] && mBodySweptBoxes.Overlap(body1, body2));
+            if (isTouching) {
+                mWokenIslands.push_back(mBodyComponents[isSleeping1 ? body1 : body2]->mIslandId);
+            }
+        }
+        if (detectedPair.status == PAIR_SENSOR) {
+            mSensorPairs.push_back({body1, body2});
             continue;
         }
-        auto motionComponent = std::static_pointer_cast<MotionComponent>(motionComponentManager->GetComponent(collisionBodyComponent->GetEntityId()));
-        if (motionComponent == nullptr) {
-            SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << collisionBodyComponent->GetEntityId();
+        if (detectedPair.status != PAIR_COLLIDING) {
             continue;
         }
-        auto actualCollisionComponentOrigin = motionComponent->GetPosition() + collisionBodyComponent->GetOffset();
-        auto collisionComponentSize = collisionBodyComponent->GetSize();
-        auto collisionComponentTopLeft = actualCollisionComponentOrigin;
-        auto collisionComponentTopRight = actualCollisionComponentOrigin + XYCoordinate<float>(collisionComponentSize.width, 0);
-        auto collisionComponentBottomLeft = actualCollisionComponentOrigin + XYCoordinate<float>(0, collisionComponentSize.height);
-        auto collisionComponentBottomRight = actualCollisionComponentOrigin + (XYCoordinate<float>)collisionComponentSize;
-        XYCoordinate<CollisionCellId> topLeftCellId = {
-            (CollisionCellId)(collisionComponentTopLeft.x / CELL_SIZE) + ((uint32_t)collisionComponentTopLeft.x % CELL_SIZE > 0),
-            (CollisionCellId)(collisionComponentTopLeft.y / CELL_SIZE) + ((uint32_t)collisionComponentTopLeft.y % CELL_SIZE > 0)
-        };
-        XYCoordinate<CollisionCellId> topRightCellId = {
-            (CollisionCellId)(collisionComponentTopRight.x / CELL_SIZE) + ((uint32_t)collisionComponentTopRight.x % CELL_SIZE > 0),
-            (CollisionCellId)(collisionComponentTopRight.y / CELL_SIZE) + ((uint32_t)collisionComponentTopRight.y % CELL_SIZE > 0)
-        };
-        XYCoordinate<CollisionCellId> bottomLeftCellId = {
-            (CollisionCellId)(collisionComponentBottomLeft.x / CELL_SIZE) + ((uint32_t)collisionComponentBottomLeft.x % CELL_SIZE > 0),
-            (CollisionCellId)(collisionComponentBottomLeft.y / CELL_SIZE) + ((uint32_t)collisionComponentBottomLeft.y % CELL_SIZE > 0)
-        };
-        XYCoordinate<CollisionCellId> bottomRightCellId = {
-            (CollisionCellId)(collisionComponentBottomRight.x / CELL_SIZE) + ((uint32_t)collisionComponentBottomRight.x % CELL_SIZE > 0),
-            (CollisionCellId)(collisionComponentBottomRight.y / CELL_SIZE) + ((uint32_t)collisionComponentBottomRight.y % CELL_SIZE > 0)
-        };
-        // Add the collision component to the cells
-        auto entityId = collisionBodyComponent->GetEntityId();
-        auto generatedCellIds = [this](XYCoordinate<CollisionCellId> topLeftCellId, XYCoordinate<CollisionCellId> topRightCellId, XYCoordinate<CollisionCellId> bottomLeftCellId, XYCoordinate<CollisionCellId> bottomRightCellId) -> std::vector<CollisionCellId> {
-            std::vector<CollisionCellId> res;
-            for (auto y=topLeftCellId.y; y<=bottomRightCellId.y; y++) {
-                for (auto x=topLeftCellId.x; x<=bottomRightCellId.x; x++) {
-                    res.push_back(CollisionCellId(y * mNumCellsX + x));
-                }
+        auto collisionTypeForEntity1 = detectedPair.collisionType;
+        if (!mBodyBoxesNextTick.Overlap(body1, body2)) {
+            SIMPLE_2D_LOG_DEBUG << "Entities " << entityId1 << " and " << entityId2 << " pass through each other during the tick";
+        }
+        auto collisionBoxNextTick1 = mBodyBoxesNextTick.Get(body1);
+        auto collisionBoxNextTick2 = mBodyBoxesNextTick.Get(body2);
+        SIMPLE_2D_LOG_DEBUG << "Entity " << entityId1 << " collisionBoxNextTick1: " << collisionBoxNextTick1;
+        SIMPLE_2D_LOG_DEBUG << "Entity " << entityId2 << " collisionBoxNextTick2: " << collisionBoxNextTick2;
+        SIMPLE_2D_LOG_DEBUG << "entity " << entityId1 << " and " << entityId2 << " are colliding";
+        // Distances between the edges of the 2 collision boxes next tick, in each axis. A body which passed through the
+        // other one is moved back by the whole distance it went past the edge it hit.
+        auto distanceCb1BottomEdgeToCb2TopEdgeNextTick = std::abs(collisionBoxNextTick2.top_left.y - collisionBoxNextTick1.bottom_right.y);
+        auto distanceCb1LeftEdgeToCb2RightEdgeNextTick = std::abs(collisionBoxNextTick2.bottom_right.x - collisionBoxNextTick1.top_left.x);
+        auto distanceCb1RightEdgeToCb2LeftEdgeNextTick = std::abs(collisionBoxNextTick2.top_left.x - collisionBoxNextTick1.bottom_right.x);
+        auto distanceCb1TopEdgeToCb2BottomEdgeNextTick = std::abs(collisionBoxNextTick2.bottom_right.y - collisionBoxNextTick1.top_left.y);
+        auto interpolateMotionForCollidingEntities = [this, distanceCb1BottomEdgeToCb2TopEdgeNextTick, distanceCb1LeftEdgeToCb2RightEdgeNextTick, distanceCb1RightEdgeToCb2LeftEdgeNextTick, distanceCb1TopEdgeToCb2BottomEdgeNextTick](CollisionBodyIndex body1, CollisionBodyIndex body2, simple_2d::CollisionBodyComponent::CollisionType collisionType) {
+            auto entityId1 = mBodyEntities[body1];
+            auto entityId2 = mBodyEntities[body2];
+            SIMPLE_2D_LOG_DEBUG << "Interpolating motion for entities " << entityId1 << " and " << entityId2 << " with collision type " << collisionType;
+            auto motionComponent1 = mBodyComponents[body1]->GetMotion();
+            if (motionComponent1 == nullptr) {
+                SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << entityId1;
+                return;
             }
-            return res;
-        };
-        auto cellIds = generatedCellIds(topLeftCellId, topRightCellId, bottomLeftCellId, bottomRightCellId);
-        for (auto cellId : cellIds) {
-            mCollisionCellEntitiesMap[cellId].insert(entityId);
-        }
-    }
-    std::map<EntityId, std::set<EntityId>> entityCollisionsMap;
-    // Then check for collisions between entities in the same cell
-    for (auto [cellId, entityIds]: mCollisionCellEntitiesMap) {
-        for (auto it=entityIds.begin(); it!=entityIds.end(); it++) {
-            for (auto it2=std::next(it); it2!=entityIds.end(); it2++) {
-                auto entityId1 = *it;
-                auto entityId2 = *it2;
-                if (entityCollisionsMap[entityId1].find(entityId2) != entityCollisionsMap[entityId1].end() || entityCollisionsMap[entityId2].find(entityId1) != entityCollisionsMap[entityId2].end()) {
-                    SIMPLE_2D_LOG_DEBUG << "Entities " << entityId1 << " and " << entityId2 << " are already collided! Skipping...";
-                    continue;
-                }
-                SIMPLE_2D_LOG_DEBUG << "Checking collision between entities " << entityId1 << " and " << entityId2 << " in cell " << cellId;
-                auto collisionBodyComponent1 = std::static_pointer_cast<CollisionBodyComponent>(GetComponent(entityId1));
-                if (nullptr == collisionBodyComponent1) {
-                    SIMPLE_2D_LOG_ERROR << "Failed to get collision body component for entity " << entityId1;
-                    continue;
-                }
-                auto collisionBodyComponent2 = std::static_pointer_cast<CollisionBodyComponent>(GetComponent(entityId2));
-                if (nullptr == collisionBodyComponent2) {
-                    SIMPLE_2D_LOG_ERROR << "Failed to get collision body component for entity " << entityId2;
-                    continue;
-                }
-                // The algorithm is simple:
-                // 1. Get the collision box of the 2 components next tick
-                // 2. If the collision box of the 2 components next tick is not overlapping, then the 2 components are not colliding
-                // 3. If the collision box of the 2 components next tick is overlapping, then the 2 components are colliding
-                // 4. If the 2 components are colliding, then we need to figure out how to handle the motion of the 2 components based
-                // on the direction of the collision by checking collision box before and after the collision.
-                // However, for this to work properly, we need to assume that last tick, 2 collision components are not colliding!!
-                // Later code will show this assumption
-                auto [err1, collisionBoxThisTick1] = collisionBodyComponent1->GetCollisionBox();
-                auto [err2, collisionBoxThisTick2] = collisionBodyComponent2->GetCollisionBox();
-                if (Error::OK != err1 || Error::OK != err2) {
-                    SIMPLE_2D_LOG_ERROR << "Failed to get collision box for entity " << entityId1 << " or " << entityId2;
-                    continue;
-                }
-                if (AreRectanglesOverlap(collisionBoxThisTick1, collisionBoxThisTick2)) {
-                    SIMPLE_2D_LOG_WARNING << "Expected that 2 components are not colliding this tick, but they are";
-                    // Currently, we don't know how to handle this case. So we just...let it stay overlapping.
-                    // This is not a good solution, but it's the best we can do for now.
-                }
-                auto [err3, collisionBoxNextTick1] = collisionBodyComponent1->GetCollisionBoxNextTick();
-                auto [err4, collisionBoxNextTick2] = collisionBodyComponent2->GetCollisionBoxNextTick();
-                SIMPLE_2D_LOG_DEBUG << "Entity " << entityId1 << " collisionBoxNextTick1: " << collisionBoxNextTick1;
-                SIMPLE_2D_LOG_DEBUG << "Entity " << entityId2 << " collisionBoxNextTick2: " << collisionBoxNextTick2;
-                if (Error::OK != err3 || Error::OK != err4) {
-                    SIMPLE_2D_LOG_ERROR << "Failed to get collision box next tick for entity " << entityId1 << " or " << entityId2;
-                    continue;
-                }
-                if (!AreRectanglesOverlap(collisionBoxNextTick1, collisionBoxNextTick2)) {
-                    continue;
-                }
-                SIMPLE_2D_LOG_DEBUG << "entity " << entityId1 << " and " << entityId2 << " are colliding";
-                auto cbThisTick1TopEdge = collisionBoxThisTick1.GetAxisAlignedEdge<float>(RectangleEdge::Top);
-                auto cbThisTick1BottomEdge = collisionBoxThisTick1.GetAxisAlignedEdge<float>(RectangleEdge::Bottom);
-                auto cbThisTick1LeftEdge = collisionBoxThisTick1.GetAxisAlignedEdge<float>(RectangleEdge::Left);
-                auto cbThisTick1RightEdge = collisionBoxThisTick1.GetAxisAlignedEdge<float>(RectangleEdge::Right);
-                auto cbThisTick2TopEdge = collisionBoxThisTick2.GetAxisAlignedEdge<float>(RectangleEdge::Top);
-                auto cbThisTick2BottomEdge = collisionBoxThisTick2.GetAxisAlignedEdge<float>(RectangleEdge::Bottom);
-                auto cbThisTick2LeftEdge = collisionBoxThisTick2.GetAxisAlignedEdge<float>(RectangleEdge::Left);
-                auto cbThisTick2RightEdge = collisionBoxThisTick2.GetAxisAlignedEdge<float>(RectangleEdge::Right);
-                auto cbNextTick1TopEdge = collisionBoxNextTick1.GetAxisAlignedEdge<float>(RectangleEdge::Top);
-                auto cbNextTick1BottomEdge = collisionBoxNextTick1.GetAxisAlignedEdge<float>(RectangleEdge::Bottom);
-                auto cbNextTick1LeftEdge = collisionBoxNextTick1.GetAxisAlignedEdge<float>(RectangleEdge::Left);
-                auto cbNextTick1RightEdge = collisionBoxNextTick1.GetAxisAlignedEdge<float>(RectangleEdge::Right);
-                auto cbNextTick2TopEdge = collisionBoxNextTick2.GetAxisAlignedEdge<float>(RectangleEdge::Top);
-                auto cbNextTick2BottomEdge = collisionBoxNextTick2.GetAxisAlignedEdge<float>(RectangleEdge::Bottom);
-                auto cbNextTick2LeftEdge = collisionBoxNextTick2.GetAxisAlignedEdge<float>(RectangleEdge::Left);
-                auto cbNextTick2RightEdge = collisionBoxNextTick2.GetAxisAlignedEdge<float>(RectangleEdge::Right);
-                // Magic happens here.
-                // Check whether the bottom edge of cb1 is colliding with the top edge of cb2
-                auto possibleCb1BottomEdgeCollidingWithCb2TopEdge = false;
-                SIMPLE_2D_LOG_DEBUG << "cbThisTick1BottomEdge: " << cbThisTick1BottomEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbThisTick2TopEdge: " << cbThisTick2TopEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbNextTick1BottomEdge: " << cbNextTick1BottomEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbNextTick2TopEdge: " << cbNextTick2TopEdge;
-                SIMPLE_2D_LOG_DEBUG << "RelativePositionBetweenAxisAlignedEdges(cbThisTick1BottomEdge, cbThisTick2TopEdge): " << RelativePositionBetweenAxisAlignedEdges(cbThisTick1BottomEdge, cbThisTick2TopEdge);
-                SIMPLE_2D_LOG_DEBUG << "RelativePositionBetweenAxisAlignedEdges(cbNextTick1BottomEdge, cbNextTick2TopEdge): " << RelativePositionBetweenAxisAlignedEdges(cbNextTick1BottomEdge, cbNextTick2TopEdge);
-                auto isCb1BottomEdgeAboveCb2TopEdgeThisTick = RelativePositionBetweenAxisAlignedEdges(cbThisTick1BottomEdge, cbThisTick2TopEdge) == AxisAlignedEdgesRelativePosition::Above;
-                auto isCb1BottomEdgeAlignedWithCb2TopEdgeThisTick = RelativePositionBetweenAxisAlignedEdges(cbThisTick1BottomEdge, cbThisTick2TopEdge) == AxisAlignedEdgesRelativePosition::Aligned;
-                auto isCb1BottomEdgeBelowCb2TopEdgeNextTick = RelativePositionBetweenAxisAlignedEdges(cbNextTick1BottomEdge, cbNextTick2TopEdge) == AxisAlignedEdgesRelativePosition::Below;
-                auto isCb1BottomEdgeAlignedWithCb2TopEdgeNextTick = RelativePositionBetweenAxisAlignedEdges(cbNextTick1BottomEdge, cbNextTick2TopEdge) == AxisAlignedEdgesRelativePosition::Aligned;
-                auto isCb1BottomEdgeAboveCb2ThenCollide = isCb1BottomEdgeAboveCb2TopEdgeThisTick && (isCb1BottomEdgeBelowCb2TopEdgeNextTick || isCb1BottomEdgeAlignedWithCb2TopEdgeNextTick);
-                auto isCb1BottomEdgeAlignedWithCb2TopEdgeThenCollide = isCb1BottomEdgeAlignedWithCb2TopEdgeThisTick && (isCb1BottomEdgeBelowCb2TopEdgeNextTick ||isCb1BottomEdgeAlignedWithCb2TopEdgeNextTick);
-                if (isCb1BottomEdgeAboveCb2ThenCollide || isCb1BottomEdgeAlignedWithCb2TopEdgeThenCollide) {
-                    possibleCb1BottomEdgeCollidingWithCb2TopEdge = true;
-                }
-                auto possibleCb1TopEdgeCollidingWithCb2BottomEdge = false;
-                SIMPLE_2D_LOG_DEBUG << "cbThisTick1TopEdge: " << cbThisTick1TopEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbThisTick2BottomEdge: " << cbThisTick2BottomEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbNextTick1TopEdge: " << cbNextTick1TopEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbNextTick2BottomEdge: " << cbNextTick2BottomEdge;
-                SIMPLE_2D_LOG_DEBUG << "RelativePositionBetweenAxisAlignedEdges(cbThisTick1TopEdge, cbThisTick2BottomEdge): " << RelativePositionBetweenAxisAlignedEdges(cbThisTick1TopEdge, cbThisTick2BottomEdge);
-                SIMPLE_2D_LOG_DEBUG << "RelativePositionBetweenAxisAlignedEdges(cbNextTick1TopEdge, cbNextTick2BottomEdge): " << RelativePositionBetweenAxisAlignedEdges(cbNextTick1TopEdge, cbNextTick2BottomEdge);
-                auto isCb1TopEdgeBelowCb2BottomEdgeThisTick = RelativePositionBetweenAxisAlignedEdges(cbThisTick1TopEdge, cbThisTick2BottomEdge) == AxisAlignedEdgesRelativePosition::Below;
-                auto isCb1TopEdgeAlignedWithCb2BottomEdgeThisTick = RelativePositionBetweenAxisAlignedEdges(cbThisTick1TopEdge, cbThisTick2BottomEdge) == AxisAlignedEdgesRelativePosition::Aligned;
-                auto isCb1TopEdgeAboveCb2BottomEdgeNextTick = RelativePositionBetweenAxisAlignedEdges(cbNextTick1TopEdge, cbNextTick2BottomEdge) == AxisAlignedEdgesRelativePosition::Above;
-                auto isCb1TopEdgeAlignedWithCb2BottomEdgeNextTick = RelativePositionBetweenAxisAlignedEdges(cbNextTick1TopEdge, cbNextTick2BottomEdge) == AxisAlignedEdgesRelativePosition::Aligned;
-                auto isCb1TopEdgeBelowCb2ThenCollide = isCb1TopEdgeBelowCb2BottomEdgeThisTick && (isCb1TopEdgeAboveCb2BottomEdgeNextTick || isCb1TopEdgeAlignedWithCb2BottomEdgeNextTick);
-                auto isCb1TopEdgeAlignedWithCb2BottomEdgeThenCollide = isCb1TopEdgeAlignedWithCb2BottomEdgeThisTick && (isCb1TopEdgeAboveCb2BottomEdgeNextTick || isCb1TopEdgeAlignedWithCb2BottomEdgeNextTick);
-                if (isCb1TopEdgeBelowCb2ThenCollide || isCb1TopEdgeAlignedWithCb2BottomEdgeThenCollide) {
-                    possibleCb1TopEdgeCollidingWithCb2BottomEdge = true;
-                }
-                auto possibleCb1LeftEdgeCollidingWithCb2RightEdge = false;
-                SIMPLE_2D_LOG_DEBUG << "cbThisTick1LeftEdge: " << cbThisTick1LeftEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbThisTick2RightEdge: " << cbThisTick2RightEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbNextTick1LeftEdge: " << cbNextTick1LeftEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbNextTick2RightEdge: " << cbNextTick2RightEdge;
-                SIMPLE_2D_LOG_DEBUG << "RelativePositionBetweenAxisAlignedEdges(cbThisTick1LeftEdge, cbThisTick2RightEdge): " << RelativePositionBetweenAxisAlignedEdges(cbThisTick1LeftEdge, cbThisTick2RightEdge);
-                SIMPLE_2D_LOG_DEBUG << "RelativePositionBetweenAxisAlignedEdges(cbNextTick1LeftEdge, cbNextTick2RightEdge): " << RelativePositionBetweenAxisAlignedEdges(cbNextTick1LeftEdge, cbNextTick2RightEdge);
-                auto isCb1LeftEdgeRightOfCb2LeftEdgeThisTick = RelativePositionBetweenAxisAlignedEdges(cbThisTick1LeftEdge, cbThisTick2RightEdge) == AxisAlignedEdgesRelativePosition::RightOf;
-                auto isCb1LeftEdgeAlignedWithCb2RightEdgeThisTick = RelativePositionBetweenAxisAlignedEdges(cbThisTick1LeftEdge, cbThisTick2RightEdge) == AxisAlignedEdgesRelativePosition::Aligned;
-                auto isCb1LeftEdgeLeftOfCb2RightEdgeNextTick = RelativePositionBetweenAxisAlignedEdges(cbNextTick1LeftEdge, cbNextTick2RightEdge) == AxisAlignedEdgesRelativePosition::LeftOf;
-                auto isCb1LeftEdgeAlignedWithCb2RightEdgeNextTick = RelativePositionBetweenAxisAlignedEdges(cbNextTick1LeftEdge, cbNextTick2RightEdge) == AxisAlignedEdgesRelativePosition::Aligned;
-                auto isCb1LeftEdgeRightOfCb2ThenCollide = isCb1LeftEdgeRightOfCb2LeftEdgeThisTick && (isCb1LeftEdgeLeftOfCb2RightEdgeNextTick || isCb1LeftEdgeAlignedWithCb2RightEdgeNextTick);
-                auto isCb1LeftEdgeAlignedWithCb2RightEdgeThenCollide = isCb1LeftEdgeAlignedWithCb2RightEdgeThisTick && (isCb1LeftEdgeLeftOfCb2RightEdgeNextTick || isCb1LeftEdgeAlignedWithCb2RightEdgeNextTick);
-                if (isCb1LeftEdgeRightOfCb2ThenCollide || isCb1LeftEdgeAlignedWithCb2RightEdgeThenCollide) {
-                    possibleCb1LeftEdgeCollidingWithCb2RightEdge = true;
-                }
-                auto possibleCb1RightEdgeCollidingWithCb2LeftEdge = false;
-                SIMPLE_2D_LOG_DEBUG << "cbThisTick1RightEdge: " << cbThisTick1RightEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbThisTick2LeftEdge: " << cbThisTick2LeftEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbNextTick1RightEdge: " << cbNextTick1RightEdge;
-                SIMPLE_2D_LOG_DEBUG << "cbNextTick2LeftEdge: " << cbNextTick2LeftEdge;
-                SIMPLE_2D_LOG_DEBUG << "RelativePositionBetweenAxisAlignedEdges(cbThisTick1RightEdge, cbThisTick2LeftEdge): " << RelativePositionBetweenAxisAlignedEdges(cbThisTick1RightEdge, cbThisTick2LeftEdge);
-                SIMPLE_2D_LOG_DEBUG << "RelativePositionBetweenAxisAlignedEdges(cbNextTick1RightEdge, cbNextTick2LeftEdge): " << RelativePositionBetweenAxisAlignedEdges(cbNextTick1RightEdge, cbNextTick2LeftEdge);
-                auto isCb1RightEdgeLeftOfCb2LeftEdgeThisTick = RelativePositionBetweenAxisAlignedEdges(cbThisTick1RightEdge, cbThisTick2LeftEdge) == AxisAlignedEdgesRelativePosition::LeftOf;
-                auto isCb1RightEdgeAlignedWithCb2LeftEdgeThisTick = RelativePositionBetweenAxisAlignedEdges(cbThisTick1RightEdge, cbThisTick2LeftEdge) == AxisAlignedEdgesRelativePosition::Aligned;
-                auto isCb1RightEdgeRightOfCb2LeftEdgeNextTick = RelativePositionBetweenAxisAlignedEdges(cbNextTick1RightEdge, cbNextTick2LeftEdge) == AxisAlignedEdgesRelativePosition::RightOf;
-                auto isCb1RightEdgeAlignedWithCb2LeftEdgeNextTick = RelativePositionBetweenAxisAlignedEdges(cbNextTick1RightEdge, cbNextTick2LeftEdge) == AxisAlignedEdgesRelativePosition::Aligned;
-                auto isCb1RightEdgeLeftOfCb2ThenCollide = isCb1RightEdgeLeftOfCb2LeftEdgeThisTick && (isCb1RightEdgeRightOfCb2LeftEdgeNextTick || isCb1RightEdgeAlignedWithCb2LeftEdgeNextTick);
-                auto isCb1RightEdgeAlignedWithCb2LeftEdgeThenCollide = isCb1RightEdgeAlignedWithCb2LeftEdgeThisTick && (isCb1RightEdgeRightOfCb2LeftEdgeNextTick || isCb1RightEdgeAlignedWithCb2LeftEdgeNextTick);
-                if (isCb1RightEdgeLeftOfCb2ThenCollide || isCb1RightEdgeAlignedWithCb2LeftEdgeThenCollide) {
-                    possibleCb1RightEdgeCollidingWithCb2LeftEdge = true;
-                }
-                auto distanceCb1BottomEdgeToCb2TopEdgeNextTick = GetDistanceBetweenAxisAlignedEdges(cbNextTick1BottomEdge, cbNextTick2TopEdge);
-                auto distanceCb1LeftEdgeToCb2RightEdgeNextTick = GetDistanceBetweenAxisAlignedEdges(cbNextTick1LeftEdge, cbNextTick2RightEdge);
-                auto distanceCb1RightEdgeToCb2LeftEdgeNextTick = GetDistanceBetweenAxisAlignedEdges(cbNextTick1RightEdge, cbNextTick2LeftEdge);
-                auto distanceCb1TopEdgeToCb2BottomEdgeNextTick = GetDistanceBetweenAxisAlignedEdges(cbNextTick1TopEdge, cbNextTick2BottomEdge);
-                auto interpolateMotionForCollidingEntities = [this, distanceCb1BottomEdgeToCb2TopEdgeNextTick, distanceCb1LeftEdgeToCb2RightEdgeNextTick, distanceCb1RightEdgeToCb2LeftEdgeNextTick, distanceCb1TopEdgeToCb2BottomEdgeNextTick](EntityId entityId1, EntityId entityId2, simple_2d::CollisionBodyComponent::CollisionType collisionType) {
-                    SIMPLE_2D_LOG_DEBUG << "Interpolating motion for entities " << entityId1 << " and " << entityId2 << " with collision type " << collisionType;
-                    auto motionComponentManager = Engine::GetInstance().GetComponentManager(ComponentType::MOTION);
-                    if (motionComponentManager == nullptr) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
-                        return;
+            auto motionComponent2 = mBodyComponents[body2]->GetMotion();
+            if (motionComponent2 == nullptr) {
+                SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << entityId2;
+                return;
+            }
+            // Bodies which are not dynamic are not pushed by collisions
+            auto isDynamic1 = mBodyTypes[body1] == CollisionBodyComponent::Dynamic;
+            auto isDynamic2 = mBodyTypes[body2] == CollisionBodyComponent::Dynamic;
+            auto velocityNextTick1 = motionComponent1->GetVelocityNextTick();
+            auto velocityNextTick2 = motionComponent2->GetVelocityNextTick();
+            auto velocityRatioY = 0.0f;
+            auto velocityRatioX = 0.0f;
+            // Which edges move towards the other body, from the boxes this tick and next tick
+            auto isBottomEdge1MovingDown = isDynamic1 && mBodyBoxes.maxY[body1] < mBodyBoxesNextTick.maxY[body1];
+            auto isTopEdge2MovingUp = isDynamic2 && mBodyBoxes.minY[body2] > mBodyBoxesNextTick.minY[body2];
+            auto isTopEdge1MovingUp = isDynamic1 && mBodyBoxes.minY[body1] > mBodyBoxesNextTick.minY[body1];
+            auto isBottomEdge2MovingDown = isDynamic2 && mBodyBoxes.maxY[body2] < mBodyBoxesNextTick.maxY[body2];
+            auto isLeftEdge1MovingLeft = isDynamic1 && mBodyBoxes.minX[body1] > mBodyBoxesNextTick.minX[body1];
+            auto isRightEdge2MovingRight = isDynamic2 && mBodyBoxes.maxX[body2] < mBodyBoxesNextTick.maxX[body2];
+            auto isRightEdge1MovingRight = isDynamic1 && mBodyBoxes.maxX[body1] < mBodyBoxesNextTick.maxX[body1];
+            auto isLeftEdge2MovingLeft = isDynamic2 && mBodyBoxes.minX[body2] > mBodyBoxesNextTick.minX[body2];
+            auto nextTickPositionY1 = motionComponent1->GetPositionNextTick().y;
+            auto nextTickPositionY2 = motionComponent2->GetPositionNextTick().y;
+            auto nextTickPositionX1 = motionComponent1->GetPositionNextTick().x;
+            auto nextTickPositionX2 = motionComponent2->GetPositionNextTick().x;
+            float newPositionY1 = 0;
+            float newPositionY2 = 0;
+            float newPositionX1 = 0;
+            float newPositionX2 = 0;
+            // Resolve motions for 2 entities will be simple: we calculate the overlapped distance in the axis of the collision,
+            // and then we reallocate their positions based on ratio of velocities (acceleration added) in the axis of the collision.
+            switch (collisionType) {
+                case CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge:
+                    velocityRatioY = GetCorrectionRatio(velocityNextTick1.y, velocityNextTick2.y, isDynamic1, isDynamic2);
+                    newPositionY1 = nextTickPositionY1 - distanceCb1BottomEdgeToCb2TopEdgeNextTick * velocityRatioY;
+                    newPositionY2 = nextTickPositionY2 + distanceCb1BottomEdgeToCb2TopEdgeNextTick * (1 - velocityRatioY);
+                    if (isDynamic1) {
+                        motionComponent1->SetPositionOneAxis(Axis::Y, newPositionY1);
+                    }
+                    if (isDynamic2) {
+                        motionComponent2->SetPositionOneAxis(Axis::Y, newPositionY2);
                     }
-                    auto motionComponent1 = std::static_pointer_cast<MotionComponent>(motionComponentManager->GetComponent(entityId1));
-                    if (motionComponent1 == nullptr) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << entityId1;
-                        return;
+                    if (isBottomEdge1MovingDown) {
+                        motionComponent1->SetVelocityOneAxis(Axis::Y, 0);
+                        motionComponent1->SetAccelerationOneAxis(Axis::Y, 0);
                     }
-                    auto motionComponent2 = std::static_pointer_cast<MotionComponent>(motionComponentManager->GetComponent(entityId2));
-                    if (motionComponent2 == nullptr) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << entityId2;
-                        return;
+                    if (isTopEdge2MovingUp) {
+                        motionComponent2->SetVelocityOneAxis(Axis::Y, 0);
+                        motionComponent2->SetAccelerationOneAxis(Axis::Y, 0);
                     }
-                    auto collisionBodyComponent1 = std::static_pointer_cast<CollisionBodyComponent>(GetComponent(entityId1));
-                    if (collisionBodyComponent1 == nullptr) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get collision body component for entity " << entityId1;
-                        return;
+                    break;
+                case CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge:
+                    velocityRatioY = GetCorrectionRatio(velocityNextTick1.y, velocityNextTick2.y, isDynamic1, isDynamic2);
+                    newPositionY1 = nextTickPositionY1 + distanceCb1TopEdgeToCb2BottomEdgeNextTick * velocityRatioY;
+                    newPositionY2 = nextTickPositionY2 - distanceCb1TopEdgeToCb2BottomEdgeNextTick * (1 - velocityRatioY);
+                    if (isDynamic1) {
+                        motionComponent1->SetPositionOneAxis(Axis::Y, newPositionY1);
                     }
-                    auto collisionBodyComponent2 = std::static_pointer_cast<CollisionBodyComponent>(GetComponent(entityId2));
-                    if (collisionBodyComponent2 == nullptr) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get collision body component for entity " << entityId2;
-                        return;
+                    if (isDynamic2) {
+                        motionComponent2->SetPositionOneAxis(Axis::Y, newPositionY2);
                     }
-                    auto [err1, collisionBoxThisTick1] = collisionBodyComponent1->GetCollisionBox();
-                    if (Error::OK != err1) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get collision box next tick for entity " << entityId1 << " or " << entityId2;
-                        return;
+                    if (isTopEdge1MovingUp) {
+                        motionComponent1->SetVelocityOneAxis(Axis::Y, 0);
+                        motionComponent1->SetAccelerationOneAxis(Axis::Y, 0);
                     }
-                    auto [err2, collisionBoxThisTick2] = collisionBodyComponent2->GetCollisionBox();
-                    if (Error::OK != err2) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get collision box next tick for entity " << entityId1 << " or " << entityId2;
-                        return;
+                    if (isBottomEdge2MovingDown) {
+                        motionComponent2->SetVelocityOneAxis(Axis::Y, 0);
+                        motionComponent2->SetAccelerationOneAxis(Axis::Y, 0);
                     }
-                    auto [err3, collisionBoxNextTick1] = collisionBodyComponent1->GetCollisionBoxNextTick();
-                    if (Error::OK != err1) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get collision box next tick for entity " << entityId1 << " or " << entityId2;
-                        return;
+                    break;
+                case CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge:
+                    velocityRatioX = GetCorrectionRatio(velocityNextTick1.x, velocityNextTick2.x, isDynamic1, isDynamic2);
+                    newPositionX1 = nextTickPositionX1 + distanceCb1LeftEdgeToCb2RightEdgeNextTick * velocityRatioX;
+                    newPositionX2 = nextTickPositionX2 - distanceCb1LeftEdgeToCb2RightEdgeNextTick * (1 - velocityRatioX);
+                    if (isDynamic1) {
+                        motionComponent1->SetPositionOneAxis(Axis::X, newPositionX1);
                     }
-                    auto [err4, collisionBoxNextTick2] = collisionBodyComponent2->GetCollisionBoxNextTick();
-                    if (Error::OK != err2) {
-                        SIMPLE_2D_LOG_ERROR << "Failed to get collision box next tick for entity " << entityId1 << " or " << entityId2;
-                        return;
+                    if (isDynamic2) {
+                        motionComponent2->SetPositionOneAxis(Axis::X, newPositionX2);
                     }
-                    auto topEdge1ThisTick = collisionBoxThisTick1.GetAxisAlignedEdge<float>(RectangleEdge::Top);
-                    auto bottomEdge1ThisTick = collisionBoxThisTick1.GetAxisAlignedEdge<float>(RectangleEdge::Bottom);
-                    auto leftEdge1ThisTick = collisionBoxThisTick1.GetAxisAlignedEdge<float>(RectangleEdge::Left);
-                    auto rightEdge1ThisTick = collisionBoxThisTick1.GetAxisAlignedEdge<float>(RectangleEdge::Right);
-                    auto topEdge2ThisTick = collisionBoxThisTick2.GetAxisAlignedEdge<float>(RectangleEdge::Top);
-                    auto bottomEdge2ThisTick = collisionBoxThisTick2.GetAxisAlignedEdge<float>(RectangleEdge::Bottom);
-                    auto leftEdge2ThisTick = collisionBoxThisTick2.GetAxisAlignedEdge<float>(RectangleEdge::Left);
-                    auto rightEdge2ThisTick = collisionBoxThisTick2.GetAxisAlignedEdge<float>(RectangleEdge::Right);
-                    auto topEdge1NextTick = collisionBoxNextTick1.GetAxisAlignedEdge<float>(RectangleEdge::Top);
-                    auto bottomEdge1NextTick = collisionBoxNextTick1.GetAxisAlignedEdge<float>(RectangleEdge::Bottom);
-                    auto leftEdge1NextTick = collisionBoxNextTick1.GetAxisAlignedEdge<float>(RectangleEdge::Left);
-                    auto rightEdge1NextTick = collisionBoxNextTick1.GetAxisAlignedEdge<float>(RectangleEdge::Right);
-                    auto topEdge2NextTick = collisionBoxNextTick2.GetAxisAlignedEdge<float>(RectangleEdge::Top);
-                    auto bottomEdge2NextTick = collisionBoxNextTick2.GetAxisAlignedEdge<float>(RectangleEdge::Bottom);
-                    auto leftEdge2NextTick = collisionBoxNextTick2.GetAxisAlignedEdge<float>(RectangleEdge::Left);
-                    auto rightEdge2NextTick = collisionBoxNextTick2.GetAxisAlignedEdge<float>(RectangleEdge::Right);
-                    auto velocityNextTick1 = motionComponent1->GetVelocityNextTick();
-                    auto velocityNextTick2 = motionComponent2->GetVelocityNextTick();
-                    auto velocityRatioY = 0.0f;
-                    auto velocityRatioX = 0.0f;
-                    auto isBottomEdge1MovingDown = RelativePositionBetweenAxisAlignedEdges(bottomEdge1ThisTick, bottomEdge1NextTick) == AxisAlignedEdgesRelativePosition::Above;
-                    auto isTopEdge2MovingUp = RelativePositionBetweenAxisAlignedEdges(topEdge2ThisTick, topEdge2NextTick) == AxisAlignedEdgesRelativePosition::Below;
-                    auto isTopEdge1MovingUp = RelativePositionBetweenAxisAlignedEdges(topEdge1ThisTick, topEdge1NextTick) == AxisAlignedEdgesRelativePosition::Below;
-                    auto isBottomEdge2MovingDown = RelativePositionBetweenAxisAlignedEdges(bottomEdge2ThisTick, bottomEdge2NextTick) == AxisAlignedEdgesRelativePosition::Above;
-                    auto isLeftEdge1MovingLeft = RelativePositionBetweenAxisAlignedEdges(leftEdge1ThisTick, leftEdge1NextTick) == AxisAlignedEdgesRelativePosition::RightOf;
-                    auto isRightEdge2MovingRight = RelativePositionBetweenAxisAlignedEdges(rightEdge2ThisTick, rightEdge2NextTick) == AxisAlignedEdgesRelativePosition::LeftOf;
-                    auto isRightEdge1MovingRight = RelativePositionBetweenAxisAlignedEdges(rightEdge1ThisTick, rightEdge1NextTick) == AxisAlignedEdgesRelativePosition::LeftOf;
-                    auto isLeftEdge2MovingLeft = RelativePositionBetweenAxisAlignedEdges(leftEdge2ThisTick, leftEdge2NextTick) == AxisAlignedEdgesRelativePosition::RightOf;
-                    auto nextTickPositionY1 = motionComponent1->GetPositionNextTick().y;
-                    auto nextTickPositionY2 = motionComponent2->GetPositionNextTick().y;
-                    auto nextTickPositionX1 = motionComponent1->GetPositionNextTick().x;
-                    auto nextTickPositionX2 = motionComponent2->GetPositionNextTick().x;
-                    float newPositionY1 = 0;
-                    float newPositionY2 = 0;
-                    float newPositionX1 = 0;
-                    float newPositionX2 = 0;
-                    // Resolve motions for 2 entities will be simple: we calculate the overlapped distance in the axis of the collision,
-                    // and then we reallocate their positions based on ratio of velocities (acceleration added) in the axis of the collision.
-                    switch (collisionType) {
-                        case CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge:
-                            velocityRatioY = velocityNextTick1.y / (velocityNextTick1.y + velocityNextTick2.y);
-                            newPositionY1 = nextTickPositionY1 - distanceCb1BottomEdgeToCb2TopEdgeNextTick * velocityRatioY;
-                            newPositionY2 = nextTickPositionY2 + distanceCb1BottomEdgeToCb2TopEdgeNextTick * (1 - velocityRatioY);
-                            motionComponent1->SetPositionOneAxis(Axis::Y, newPositionY1);
-                            motionComponent2->SetPositionOneAxis(Axis::Y, newPositionY2);
-                            if (isBottomEdge1MovingDown) {
-                                motionComponent1->SetVelocityOneAxis(Axis::Y, 0);
-                                motionComponent1->SetAccelerationOneAxis(Axis::Y, 0);
-                            }
-                            if (isTopEdge2MovingUp) {
-                                motionComponent2->SetVelocityOneAxis(Axis::Y, 0);
-                                motionComponent2->SetAccelerationOneAxis(Axis::Y, 0);
-                            }
-                            break;
-                        case CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge:
-                            velocityRatioY = velocityNextTick1.y / (velocityNextTick1.y + velocityNextTick2.y);
-                            newPositionY1 = nextTickPositionY1 + distanceCb1TopEdgeToCb2BottomEdgeNextTick * velocityRatioY;
-                            newPositionY2 = nextTickPositionY2 - distanceCb1TopEdgeToCb2BottomEdgeNextTick * (1 - velocityRatioY);
-                            motionComponent1->SetPositionOneAxis(Axis::Y, newPositionY1);
-                            motionComponent2->SetPositionOneAxis(Axis::Y, newPositionY2);
-                            if (isTopEdge1MovingUp) {
-                                motionComponent1->SetVelocityOneAxis(Axis::Y, 0);
-                                motionComponent1->SetAccelerationOneAxis(Axis::Y, 0);
-                            }
-                            if (isBottomEdge2MovingDown) {
-                                motionComponent2->SetVelocityOneAxis(Axis::Y, 0);
-                                motionComponent2->SetAccelerationOneAxis(Axis::Y, 0);
-                            }
-                            break;
-                        case CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge:
-                            velocityRatioX = velocityNextTick1.x / (velocityNextTick1.x + velocityNextTick2.x);
-                            newPositionX1 = nextTickPositionX1 + distanceCb1LeftEdgeToCb2RightEdgeNextTick * velocityRatioX;
-                            newPositionX2 = nextTickPositionX2 - distanceCb1LeftEdgeToCb2RightEdgeNextTick * (1 - velocityRatioX);
-                            motionComponent1->SetPositionOneAxis(Axis::X, newPositionX1);
-                            motionComponent2->SetPositionOneAxis(Axis::X, newPositionX2);
-                            if (isLeftEdge1MovingLeft) {
-                                motionComponent1->SetVelocityOneAxis(Axis::X, 0);
-                                motionComponent1->SetAccelerationOneAxis(Axis::X, 0);
-                            }
-                            if (isRightEdge2MovingRight) {
-                                motionComponent2->SetVelocityOneAxis(Axis::X, 0);
-                                motionComponent2->SetAccelerationOneAxis(Axis::X, 0);
-                            }
-                            break;
-                        case CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge:
-                            velocityRatioX = velocityNextTick1.x / (velocityNextTick1.x + velocityNextTick2.x);
-                            newPositionX1 = nextTickPositionX1 - distanceCb1RightEdgeToCb2LeftEdgeNextTick * velocityRatioX;
-                            newPositionX2 = nextTickPositionX2 + distanceCb1RightEdgeToCb2LeftEdgeNextTick * (1 - velocityRatioX);
-                            motionComponent1->SetPositionOneAxis(Axis::X, newPositionX1);
-                            motionComponent2->SetPositionOneAxis(Axis::X, newPositionX2);
-                            if (isRightEdge1MovingRight) {
-                                motionComponent1->SetVelocityOneAxis(Axis::X, 0);
-                                motionComponent1->SetAccelerationOneAxis(Axis::X, 0);
-                            }
-                            if (isLeftEdge2MovingLeft) {
-                                motionComponent2->SetVelocityOneAxis(Axis::X, 0);
-                                motionComponent2->SetAccelerationOneAxis(Axis::X, 0);
-                            }
-                            break;
+                    if (isLeftEdge1MovingLeft) {
+                        motionComponent1->SetVelocityOneAxis(Axis::X, 0);
+                        motionComponent1->SetAccelerationOneAxis(Axis::X, 0);
                     }
-                };
-                SIMPLE_2D_LOG_DEBUG << "Possible cb1 bottom edge colliding with cb2 top edge: " << possibleCb1BottomEdgeCollidingWithCb2TopEdge;
-                SIMPLE_2D_LOG_DEBUG << "Possible cb1 top edge colliding with cb2 bottom edge: " << possibleCb1TopEdgeCollidingWithCb2BottomEdge;
-                SIMPLE_2D_LOG_DEBUG << "Possible cb1 left edge colliding with cb2 right edge: " << possibleCb1LeftEdgeCollidingWithCb2RightEdge;
-                SIMPLE_2D_LOG_DEBUG << "Possible cb1 right edge colliding with cb2 left edge: " << possibleCb1RightEdgeCollidingWithCb2LeftEdge;
-                auto collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge;
-                auto collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge;
-                if (possibleCb1BottomEdgeCollidingWithCb2TopEdge && possibleCb1LeftEdgeCollidingWithCb2RightEdge) {
-                    // Another magic! Let me explain how to know what pair of edges will collide first:
-                    // - We check the distance between 2 pairs of edges next tick.
-                    // - How to decide what collide first? Which pair has smaller distance WILL BE COLLIDE FIRST. You can check by yourself
-                    //   by a thought experiment: one rectangle is moving very fast in axis X but move slower in axis Y. If it
-                    //   overlapped with another rectangle, axis X is definitely cover more distance than axis Y. But...it's
-                    //   actually axis Y collide first!
-                    if (distanceCb1BottomEdgeToCb2TopEdgeNextTick < distanceCb1LeftEdgeToCb2RightEdgeNextTick) {
-                        // Bottom edge of cb1 is colliding with top edge of cb2. For entity 2, the collision type is the opposite of entity 1.
-                        collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge;
-                        collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge;
-                    } else {
-                        // The collision is happening in the X axis. Means left edge of cb1 is colliding with right edge of cb2.
-                        collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge;
-                        collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge;
+                    if (isRightEdge2MovingRight) {
+                        motionComponent2->SetVelocityOneAxis(Axis::X, 0);
+                        motionComponent2->SetAccelerationOneAxis(Axis::X, 0);
                     }
-                } else if (possibleCb1BottomEdgeCollidingWithCb2TopEdge && possibleCb1RightEdgeCollidingWithCb2LeftEdge) {
-                    if (distanceCb1BottomEdgeToCb2TopEdgeNextTick < distanceCb1RightEdgeToCb2LeftEdgeNextTick) {
-                        collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge;
-                        collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge;
-                    } else {
-                        collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge;
-                        collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge;
+                    break;
+                case CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge:
+                    velocityRatioX = GetCorrectionRatio(velocityNextTick1.x, velocityNextTick2.x, isDynamic1, isDynamic2);
+                    newPositionX1 = nextTickPositionX1 - distanceCb1RightEdgeToCb2LeftEdgeNextTick * velocityRatioX;
+                    newPositionX2 = nextTickPositionX2 + distanceCb1RightEdgeToCb2LeftEdgeNextTick * (1 - velocityRatioX);
+                    if (isDynamic1) {
+                        motionComponent1->SetPositionOneAxis(Axis::X, newPositionX1);
                     }
-                } else if (possibleCb1TopEdgeCollidingWithCb2BottomEdge && possibleCb1LeftEdgeCollidingWithCb2RightEdge) {
-                    if (distanceCb1TopEdgeToCb2BottomEdgeNextTick < distanceCb1LeftEdgeToCb2RightEdgeNextTick) {
-                        collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge;
-                        collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge;
-                    } else {
-                        collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge;
-                        collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge;
+                    if (isDynamic2) {
+                        motionComponent2->SetPositionOneAxis(Axis::X, newPositionX2);
                     }
-                } else if (possibleCb1TopEdgeCollidingWithCb2BottomEdge && possibleCb1RightEdgeCollidingWithCb2LeftEdge) {
-                    if (distanceCb1TopEdgeToCb2BottomEdgeNextTick < distanceCb1RightEdgeToCb2LeftEdgeNextTick) {
-                        collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge;
-                        collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge;
-                    } else {
-                        collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge;
-                        collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge;
+                    if (isRightEdge1MovingRight) {
+                        motionComponent1->SetVelocityOneAxis(Axis::X, 0);
+                        motionComponent1->SetAccelerationOneAxis(Axis::X, 0);
                     }
-                } else if (possibleCb1BottomEdgeCollidingWithCb2TopEdge) {
-                    collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge;
-                    collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge;
-                } else if (possibleCb1TopEdgeCollidingWithCb2BottomEdge) {
-                    collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge;
-                    collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge;
-                } else if (possibleCb1LeftEdgeCollidingWithCb2RightEdge) {
-                    collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge;
-                    collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge;
-                } else if (possibleCb1RightEdgeCollidingWithCb2LeftEdge) {
-                    collisionTypeForEntity1 = CollisionBodyComponent::CollisionType::Cb1RightEdgeCollidingWithCb2LeftEdge;
-                    collisionTypeForEntity2 = CollisionBodyComponent::CollisionType::Cb1LeftEdgeCollidingWithCb2RightEdge;
-                }
-                interpolateMotionForCollidingEntities(entityId1, entityId2, collisionTypeForEntity1);
-                collisionBodyComponent1->NotifyCollision(entityId2, collisionTypeForEntity1);
-                collisionBodyComponent2->NotifyCollision(entityId1, collisionTypeForEntity2);
-                entityCollisionsMap[entityId1].insert(entityId2);
-                entityCollisionsMap[entityId2].insert(entityId1);
+                    if (isLeftEdge2MovingLeft) {
+                        motionComponent2->SetVelocityOneAxis(Axis::X, 0);
+                        motionComponent2->SetAccelerationOneAxis(Axis::X, 0);
+                    }
+                    break;
             }
+        };
+        auto pairKey = MakeCollisionPairKey(entityId1, entityId2);
+        auto isNewContact = false;
+        auto &contact = mContacts.FindOrInsert(pairKey, isNewContact);
+        auto collisionTypeForEntity2 = GetOppositeCollisionType(collisionTypeForEntity1);
+        contact.lastTick = mTick;
+        interpolateMotionForCollidingEntities(body1, body2, collisionTypeForEntity1);
+        mCollidingPairs.push_back({body1, body2});
+        auto eventType = isNewContact ? COLLISION_ENTER_EVENT : COLLISION_STAY_EVENT;
+        QueueEvent(entityId1, entityId2, eventType, collisionTypeForEntity1);
+        QueueEvent(entityId2, entityId1, eventType, collisionTypeForEntity2);
+        // Later pairs must see where the resolution moved the 2 bodies
+        RefreshBodyBoxes(body1);
+        RefreshBodyBoxes(body2);
+    }
+    WakeIslands();
+    UpdateSleepingBodies();
+    // Contacts which were not seen this tick have ended, unless both bodies are resting
+    mEndedContacts.clear();
+    mContacts.ForEach([this](CollisionPairKey pairKey, const Contact &contact) {
+        if (contact.lastTick != mTick && contact.lastTick != FROZEN_TICK) {
+            mEndedContacts.push_back(pairKey);
         }
+    });
+    // The order of the table depends on its history, the order of the keys does not
+    std::sort(mEndedContacts.begin(), mEndedContacts.end());
+    for (auto pairKey : mEndedContacts) {
+        mContacts.Erase(pairKey);
+        auto entityId1 = EntityId(pairKey >> 32);
+        auto entityId2 = EntityId(pairKey);
+        SIMPLE_2D_LOG_DEBUG << "Entities " << entityId1 << " and " << entityId2 << " are not in contact anymore";
+        QueueEvent(entityId1, entityId2, COLLISION_EXIT_EVENT);
+        QueueEvent(entityId2, entityId1, COLLISION_EXIT_EVENT);
+    }
+    UpdateOverlaps();
+    mBodiesBounds = Rectangle<float>({{std::numeric_limits<float>::max(), std::numeric_limits<float>::max()}, {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()}});
+    for (CollisionBodyIndex body = 0; body < numBodies; body++) {
+        mBodiesBounds.top_left.x = std::min(mBodiesBounds.top_left.x, mBodyBoxesNextTick.minX[body]);
+        mBodiesBounds.top_left.y = std::min(mBodiesBounds.top_left.y, mBodyBoxesNextTick.minY[body]);
+        mBodiesBounds.bottom_right.x = std::max(mBodiesBounds.bottom_right.x, mBodyBoxesNextTick.maxX[body]);
+        mBodiesBounds.bottom_right.y = std::max(mBodiesBounds.bottom_right.y, mBodyBoxesNextTick.maxY[body]);
     }
+    DispatchEvents();
 }
 
+void simple_2d::CollisionBodyComponentManager::SetGroupEventsByReceiver(bool isGroupEventsByReceiver) {
+    mIsGroupEventsByReceiver = isGroupEventsByReceiver;
+}
+
+bool simple_2d::CollisionBodyComponentManager::IsGroupEventsByReceiver() const {
+    return mIsGroupEventsByReceiver;
+}
+
+size_t simple_2d::CollisionBodyComponentManager::GetNumEventsLastStep() const {
+    return mNumEventsLastStep;
+}
+
+size_t simple_2d::CollisionBodyComponentManager::GetNumSleepingBodies() const {
+    return mSleepingBodies.size();
+}
+
+bool simple_2d::CollisionBodyComponentManager::IsBodySleeping(CollisionBodyIndex body) const {
+    // Sleeping bodies are at the end of the static part of the snapshot. Reads no component, which may have been removed.
+    return body < mNumStaticBodies && body >= mNumStaticBodies - mSleepingBodies.size();
+}
+
+void simple_2d::CollisionBodyComponentManager::WakeIslands() {
+    if (mWokenIslands.empty()) {
+        return;
+    }
+    for (auto body : mSleepingBodies) {
+        auto collisionBodyComponent = mComponents.Find(mBodyEntities[body]);
+        if (collisionBodyComponent == nullptr || std::find(mWokenIslands.begin(), mWokenIslands.end(), collisionBodyComponent->mIslandId) == mWokenIslands.end()) {
+            continue;
+        }
+        auto motionComponent = collisionBodyComponent->GetMotion();
+        if (motionComponent != nullptr) {
+            SIMPLE_2D_LOG_DEBUG << "Entity " << mBodyEntities[body] << " wakes up";
+            motionComponent->WakeUp();
+        }
+    }
+    mWokenIslands.clear();
+    mAreStaticBodiesDirty = true;
+}
+
+void simple_2d::CollisionBodyComponentManager::WakeIslandsOfChangedBodies() {
+    mChangedEntities.clear();
+    for (CollisionBodyIndex body = 0; body < mBodyEntities.size(); body++) {
+        if (mBodyTypes[body] == CollisionBodyComponent::Dynamic || IsBodySleeping(body)) {
+            continue;
+        }
+        // The snapshot may point to removed components, so look the body up again
+        auto entityId = mBodyEntities[body];
+        auto collisionBodyComponent = mComponents.Find(entityId);
+        auto motionComponent = collisionBodyComponent != nullptr ? collisionBodyComponent->GetMotion() : nullptr;
+        auto isChanged = motionComponent == nullptr || !collisionBodyComponent->IsEnabled() || collisionBodyComponent->GetBodyType() != mBodyTypes[body];
+        if (!isChanged) {
+            // Where the body is now, which is where the snapshot expected it next tick unless it was moved or resized
+            auto topLeft = motionComponent->GetPosition() + collisionBodyComponent->GetOffset();
+            auto size = collisionBodyComponent->GetSize();
+            isChanged = topLeft.x != mBodyBoxesNextTick.minX[body] || topLeft.y != mBodyBoxesNextTick.minY[body] ||
+                        topLeft.x + size.width != mBodyBoxesNextTick.maxX[body] || topLeft.y + size.height != mBodyBoxesNextTick.maxY[body];
+        }
+        if (isChanged) {
+            mChangedEntities.push_back(entityId);
+        }
+    }
+    if (mChangedEntities.empty()) {
+        return;
+    }
+    std::sort(mChangedEntities.begin(), mChangedEntities.end());
+    auto wakeIslandOf = [this](EntityId entityId) {
+        auto collisionBodyComponent = mComponents.Find(entityId);
+        if (collisionBodyComponent == nullptr) {
+            return;
+        }
+        auto motionComponent = collisionBodyComponent->GetMotion();
+        if (motionComponent != nullptr && !motionComponent->IsAwake()) {
+            mWokenIslands.push_back(collisionBodyComponent->mIslandId);
+        }
+    };
+    mContacts.ForEach([this, &wakeIslandOf](CollisionPairKey pairKey, const Contact &contact) {
+        auto entityId1 = EntityId(pairKey >> 32);
+        auto entityId2 = EntityId(pairKey);
+        if (contact.lastTick != FROZEN_TICK) {
+            return;
+        }
+        if (std::binary_search(mChangedEntities.begin(), mChangedEntities.end(), entityId1)) {
+            wakeIslandOf(entityId2);
+        }
+        if (std::binary_search(mChangedEntities.begin(), mChangedEntities.end(), entityId2)) {
+            wakeIslandOf(entityId1);
+        }
+    });
+    WakeIslands();
+}
+
+void simple_2d::CollisionBodyComponentManager::UpdateSleepingBodies() {
+    auto numBodies = CollisionBodyIndex(mBodyEntities.size());
+    auto hasIslandAtRest = false;
+    for (auto body = mNumStaticBodies; body < numBodies; body++) {
+        if (mBodyTypes[body] != CollisionBodyComponent::Dynamic) {
+            continue;
+        }
+        auto collisionBodyComponent = mBodyComponents[body];
+        auto motionComponent = collisionBodyComponent->GetMotion();
+        if (motionComponent == nullptr) {
+            continue;
+        }
+        auto velocityNextTick = motionComponent->GetVelocityNextTick();
+        auto isAtRest = velocityNextTick.x * velocityNextTick.x + velocityNextTick.y * velocityNextTick.y <= SLEEP_SPEED * SLEEP_SPEED;
+        if (collisionBodyComponent->IsSleepingAllowed() && isAtRest) {
+            collisionBodyComponent->mRestTicks++;
+            hasIslandAtRest = hasIslandAtRest || collisionBodyComponent->mRestTicks >= SLEEP_TICKS;
+        } else {
+            collisionBodyComponent->mRestTicks = 0;
+        }
+    }
+    if (!hasIslandAtRest) {
+        return;
+    }
+    // Islands of the dynamic bodies colliding with each other. Static and kinematic bodies do not join islands: bodies
+    // resting on a moving one are not at rest, and they wake up when it moves into them.
+    mIslandParents.resize(numBodies);
+    for (auto body = mNumStaticBodies; body < numBodies; body++) {
+        mIslandParents[body] = body;
+    }
+    for (auto [body1, body2] : mCollidingPairs) {
+        if (mBodyTypes[body1] != CollisionBodyComponent::Dynamic || mBodyTypes[body2] != CollisionBodyComponent::Dynamic) {
+            continue;
+        }
+        auto root1 = FindIslandRoot(body1);
+        auto root2 = FindIslandRoot(body2);
+        // The smaller index is the root, so islands only depend on the pairs
+        mIslandParents[std::max(root1, root2)] = std::min(root1, root2);
+    }
+    mIslandRestTicks.assign(numBodies, UINT32_MAX);
+    for (auto body = mNumStaticBodies; body < numBodies; body++) {
+        if (mBodyTypes[body] == CollisionBodyComponent::Dynamic) {
+            auto &restTicks = mIslandRestTicks[FindIslandRoot(body)];
+            restTicks = std::min(restTicks, mBodyComponents[body]->mRestTicks);
+        }
+    }
+    mIslandIds.assign(numBodies, 0);
+    for (auto body = mNumStaticBodies; body < numBodies; body++) {
+        if (mBodyTypes[body] != CollisionBodyComponent::Dynamic) {
+            continue;
+        }
+        auto root = FindIslandRoot(body);
+        if (mIslandRestTicks[root] < SLEEP_TICKS) {
+            continue;
+        }
+        if (mIslandIds[root] == 0) {
+            mIslandIds[root] = mNextIslandId++;
+        }
+        auto collisionBodyComponent = mBodyComponents[body];
+        SIMPLE_2D_LOG_DEBUG << "Entity " << mBodyEntities[body] << " goes to sleep in island " << mIslandIds[root];
+        collisionBodyComponent->mIslandId = mIslandIds[root];
+        collisionBodyComponent->mRestTicks = 0;
+        collisionBodyComponent->GetMotion()->Sleep();
+        // Where the spatial queries see it
+        RefreshBodyBoxes(body);
+        mAreStaticBodiesDirty = true;
+    }
+}
+
+simple_2d::CollisionBodyIndex simple_2d::CollisionBodyComponentManager::FindIslandRoot(CollisionBodyIndex body) {
+    while (mIslandParents[body] != body) {
+        // Path halving
+        mIslandParents[body] = mIslandParents[mIslandParents[body]];
+        body = mIslandParents[body];
+    }
+    return body;
+}
+
+bool simple_2d::CollisionBodyComponentManager::IsEntityResting(EntityId entityId) const {
+    auto collisionBodyComponent = mComponents.Find(entityId);
+    if (collisionBodyComponent == nullptr || !collisionBodyComponent->IsEnabled()) {
+        return false;
+    }
+    if (collisionBodyComponent->GetBodyType() != CollisionBodyComponent::Dynamic) {
+        return true;
+    }
+    auto motionComponent = collisionBodyComponent->GetMotion();
+    return motionComponent != nullptr && !motionComponent->IsAwake();
+}
+
+void simple_2d::CollisionBodyComponentManager::UpdateOverlaps() {
+    // The boxes include the resolution of the collisions of this tick
+    for (auto [body1, body2] : mSensorPairs) {
+        if (!mBodyBoxesNextTick.Overlap(body1, body2)) {
+            continue;
+        }
+        auto entityId1 = mBodyEntities[body1];
+        auto entityId2 = mBodyEntities[body2];
+        auto isNewOverlap = false;
+        auto &lastTick = mOverlaps.FindOrInsert(MakeCollisionPairKey(entityId1, entityId2), isNewOverlap);
+        lastTick = mTick;
+        if (isNewOverlap) {
+            SIMPLE_2D_LOG_DEBUG << "Entities " << entityId1 << " and " << entityId2 << " start overlapping";
+            QueueEvent(entityId1, entityId2, OVERLAP_ENTER_EVENT);
+            QueueEvent(entityId2, entityId1, OVERLAP_ENTER_EVENT);
+        }
+    }
+    mEndedOverlaps.clear();
+    mOverlaps.ForEach([this](CollisionPairKey pairKey, uint32_t lastTick) {
+        if (lastTick != mTick && lastTick != FROZEN_TICK) {
+            mEndedOverlaps.push_back(pairKey);
+        }
+    });
+    std::sort(mEndedOverlaps.begin(), mEndedOverlaps.end());
+    for (auto pairKey : mEndedOverlaps) {
+        mOverlaps.Erase(pairKey);
+        auto entityId1 = EntityId(pairKey >> 32);
+        auto entityId2 = EntityId(pairKey);
+        SIMPLE_2D_LOG_DEBUG << "Entities " << entityId1 << " and " << entityId2 << " stop overlapping";
+        QueueEvent(entityId1, entityId2, OVERLAP_EXIT_EVENT);
+        QueueEvent(entityId2, entityId1, OVERLAP_EXIT_EVENT);
+    }
+}
+
+void simple_2d::CollisionBodyComponentManager::QueueEvent(EntityId receiverId, EntityId otherEntityId, CollisionEventType type, CollisionBodyComponent::CollisionType collisionType) {
+    mEvents.push_back({receiverId, otherEntityId, type, collisionType});
+}
+
+void simple_2d::CollisionBodyComponentManager::DispatchEvents() {
+    if (mIsGroupEventsByReceiver) {
+        // Stable, so the events of a receiver stay in the order they happened
+        std::stable_sort(mEvents.begin(), mEvents.end(), [](const CollisionEvent &event1, const CollisionEvent &event2) {
+            return event1.receiverId < event2.receiverId;
+        });
+    }
+    for (auto &event : mEvents) {
+        auto collisionBodyComponent = mComponents.Find(event.receiverId);
+        if (collisionBodyComponent == nullptr) {
+            continue;
+        }
+        switch (event.type) {
+            case COLLISION_ENTER_EVENT:
+                collisionBodyComponent->NotifyCollision(event.otherEntityId, event.collisionType);
+                collisionBodyComponent->NotifyCollisionEnter(event.otherEntityId, event.collisionType);
+                break;
+            case COLLISION_STAY_EVENT:
+                collisionBodyComponent->NotifyCollision(event.otherEntityId, event.collisionType);
+                collisionBodyComponent->NotifyCollisionStay(event.otherEntityId, event.collisionType);
+                break;
+            case COLLISION_EXIT_EVENT:
+                collisionBodyComponent->NotifyCollisionExit(event.otherEntityId);
+                break;
+            case OVERLAP_ENTER_EVENT:
+                collisionBodyComponent->NotifyOverlapEnter(event.otherEntityId);
+                break;
+            case OVERLAP_EXIT_EVENT:
+                collisionBodyComponent->NotifyOverlapExit(event.otherEntityId);
+                break;
+        }
+    }
+    mNumEventsLastStep = mEvents.size();
+    mEvents.clear();
+}
+
+void simple_2d::CollisionBodyComponentManager::MarkStaticBodiesDirty() {
+    mAreStaticBodiesDirty = true;
+}
+
+void simple_2d::CollisionBodyComponentManager::SetBroadphaseType(BroadphaseType broadphaseType) {
+    // Size the broadphases to the scene owning this manager. Only the constructor runs before the scene is set, and
+    // falls back to the current scene there
+    auto sceneDimensions = mScene != nullptr ? mScene->GetDimensions()
+                                             : Engine::GetInstance().GetCurrentScene()->GetDimensions();
+    mBroadphaseType = broadphaseType;
+    mBroadphase = CreateBroadphase(broadphaseType, sceneDimensions, CELL_SIZE);
+    mStaticBroadphase = CreateBroadphase(broadphaseType, sceneDimensions, CELL_SIZE);
+    mBroadphase->SetFilters(&mBodyFilters);
+    mStaticBroadphase->SetFilters(&mBodyFilters);
+    mAreStaticBodiesDirty = true;
+}
+
+simple_2d::BroadphaseType simple_2d::CollisionBodyComponentManager::GetBroadphaseType() const {
+    return mBroadphaseType;
+}
+
+const simple_2d::Broadphase* simple_2d::CollisionBodyComponentManager::GetBroadphase() const {
+    return mBroadphase.get();
+}
+
+void simple_2d::CollisionBodyComponentManager::RebuildStaticBodies() {
+    // Before the snapshot is replaced, so that the woken bodies are snapshot as moving ones
+    WakeIslandsOfChangedBodies();
+    mBodyEntities.clear();
+    mBodyComponents.clear();
+    mBodyTypes.clear();
+    mBodyFilters.clear();
+    mBodyIsSensor.clear();
+    mBodyBoxes.Clear();
+    mBodySweptBoxes.Clear();
+    mBodyBoxesNextTick.Clear();
+    mScene->View<CollisionBodyComponent, MotionComponent>().ForEach([this](EntityId entityId, CollisionBodyComponent &collisionBodyComponent, MotionComponent &motion) {
+        if (collisionBodyComponent.IsEnabled() && collisionBodyComponent.GetBodyType() == CollisionBodyComponent::Static) {
+            AddBodyToSnapshot(entityId, collisionBodyComponent, motion);
+        }
+    });
+    mSleepingBodies.clear();
+    mSleepingIslandIds.clear();
+    mScene->View<CollisionBodyComponent, MotionComponent>().ForEach([this](EntityId entityId, CollisionBodyComponent &collisionBodyComponent, MotionComponent &motion) {
+        if (collisionBodyComponent.IsEnabled() && collisionBodyComponent.GetBodyType() != CollisionBodyComponent::Static && !motion.IsAwake()) {
+            mSleepingBodies.push_back(CollisionBodyIndex(mBodyEntities.size()));
+            mSleepingIslandIds.push_back(collisionBodyComponent.mIslandId);
+            AddBodyToSnapshot(entityId, collisionBodyComponent, motion);
+        }
+    });
+    mNumStaticBodies = CollisionBodyIndex(mBodyEntities.size());
+    mStaticBroadphase->Update(mBodyEntities, mBodySweptBoxes, 0, mNumStaticBodies);
+    mAreStaticBodiesDirty = false;
+    mStaticBodiesStorageVersion = mComponents.GetVersion();
+    // Pairs of resting bodies are not checked anymore, so their contacts and overlaps are frozen instead of ending. Frozen
+    // pairs with a body which woke up, changed or was removed are checked again from this tick.
+    mContacts.ForEach([this](CollisionPairKey pairKey, Contact &contact) {
+        if (IsEntityResting(EntityId(pairKey >> 32)) && IsEntityResting(EntityId(pairKey))) {
+            contact.lastTick = FROZEN_TICK;
+        } else if (contact.lastTick == FROZEN_TICK) {
+            contact.lastTick = 0;
+        }
+    });
+    mOverlaps.ForEach([this](CollisionPairKey pairKey, uint32_t &lastTick) {
+        if (IsEntityResting(EntityId(pairKey >> 32)) && IsEntityResting(EntityId(pairKey))) {
+            lastTick = FROZEN_TICK;
+        } else if (lastTick == FROZEN_TICK) {
+            lastTick = 0;
+        }
+    });
+    SIMPLE_2D_LOG_DEBUG << "Rebuilt static collision bodies: " << mNumStaticBodies - mSleepingBodies.size() << ", sleeping: " << mSleepingBodies.size();
+}
+
+void simple_2d::CollisionBodyComponentManager::AddBodyToSnapshot(EntityId entityId, CollisionBodyComponent &collisionBodyComponent, const MotionComponent &motion) {
+    auto size = (XYCoordinate<float>)collisionBodyComponent.GetSize();
+    auto collisionBoxTopLeft = motion.GetPosition() + collisionBodyComponent.GetOffset();
+    // Sleeping bodies act as static ones until they wake up
+    auto bodyType = motion.IsAwake() ? collisionBodyComponent.GetBodyType() : CollisionBodyComponent::Static;
+    // Static bodies do not move, whatever their motion component says
+    auto collisionBoxTopLeftNextTick = bodyType == CollisionBodyComponent::Static ? collisionBoxTopLeft : motion.GetPositionNextTick() + collisionBodyComponent.GetOffset();
+    mBodyEntities.push_back(entityId);
+    mBodyComponents.push_back(&collisionBodyComponent);
+    mBodyTypes.push_back(bodyType);
+    mBodyFilters.push_back(collisionBodyComponent.GetCollisionFilter());
+    mBodyIsSensor.push_back(collisionBodyComponent.IsSensor());
+    mBodyBoxes.PushBack(Rectangle<float>({collisionBoxTopLeft, collisionBoxTopLeft + size}));
+    mBodyBoxesNextTick.PushBack(Rectangle<float>({collisionBoxTopLeftNextTick, collisionBoxTopLeftNextTick + size}));
+    auto sweptTopLeft = XYCoordinate<float>(std::min(collisionBoxTopLeft.x, collisionBoxTopLeftNextTick.x), std::min(collisionBoxTopLeft.y, collisionBoxTopLeftNextTick.y));
+    auto sweptBottomRight = XYCoordinate<float>(std::max(collisionBoxTopLeft.x, collisionBoxTopLeftNextTick.x), std::max(collisionBoxTopLeft.y, collisionBoxTopLeftNextTick.y)) + size;
+    mBodySweptBoxes.PushBack(Rectangle<float>({sweptTopLeft, sweptBottomRight}));
+}
+
+// Fractions of the tick between which 2 intervals overlap, interval 1 moving by displacement relative to interval 2.
+// Returns false if they never overlap.
+static bool sweepAxis(float min1, float max1, float min2, float max2, float displacement, float &entry, float &exit) {
+    if (displacement > 0) {
+        entry = (min2 - max1) / displacement;
+        exit = (max2 - min1) / displacement;
+    } else if (displacement < 0) {
+        entry = (max2 - min1) / displacement;
+        exit = (min2 - max1) / displacement;
+    } else {
+        entry = -std::numeric_limits<float>::infinity();
+        exit = std::numeric_limits<float>::infinity();
+        return min1 <= max2 && min2 <= max1;
+    }
+    return true;
+}
+
+bool simple_2d::CollisionBodyComponentManager::SweepBodies(CollisionBodyIndex body1, CollisionBodyIndex body2, CollisionBodyComponent::CollisionType &collisionType) const {
+    auto displacementX = (mBodyBoxesNextTick.minX[body1] - mBodyBoxes.minX[body1]) - (mBodyBoxesNextTick.minX[body2] - mBodyBoxes.minX[body2]);
+    auto displacementY = (mBodyBoxesNextTick.minY[body1] - mBodyBoxes.minY[body1]) - (mBodyBoxesNextTick.minY[body2] - mBodyBoxes.minY[body2]);
+    float entryX, exitX, entryY, exitY;
+    if (!sweepAxis(mBodyBoxes.minX[body1], mBodyBoxes.maxX[body1], mBodyBoxes.minX[body2], mBodyBoxes.maxX[body2], displacementX, entryX, exitX) ||
+        !sweepAxis(mBodyBoxes.minY[body1], mBodyBoxes.maxY[body1], mBodyBoxes.minY[body2], mBodyBoxes.maxY[body2], displacementY, entryY, exitY)) {
+        return false;
+    }
+    // The boxes overlap, touching included, from entry to exit
+    auto entry = std::max(entryX, entryY);
+    auto exit = std::min(exitX, exitY);
+    if (!(entry <= exit) || entry > 1 || (entry < 0 && exit < 1)) {
+        return false;
+    }
+    if (entry >= 0) {
+        // Ties go to Y, so that landing on a corner is landing
+        if (entryX > entryY) {
+            collisionType = displacementX > 0 ? CollisionBodyComponent::Cb1RightEdgeCollidingWithCb2LeftEdge : CollisionBodyComponent::Cb1LeftEdgeCollidingWithCb2RightEdge;
+        } else {
+            collisionType = displacementY > 0 ? CollisionBodyComponent::Cb1BottomEdgeCollidingWithCb2TopEdge : CollisionBodyComponent::Cb1TopEdgeCollidingWithCb2BottomEdge;
+        }
+        return true;
+    }
+    // Already overlapping this tick. Separate them along the axis where they overlap the least next tick.
+    auto &boxes = mBodyBoxesNextTick;
+    auto overlapX = std::min(boxes.maxX[body1], boxes.maxX[body2]) - std::max(boxes.minX[body1], boxes.minX[body2]);
+    auto overlapY = std::min(boxes.maxY[body1], boxes.maxY[body2]) - std::max(boxes.minY[body1], boxes.minY[body2]);
+    if (overlapX < overlapY) {
+        auto isBody1LeftOfBody2 = boxes.minX[body1] + boxes.maxX[body1] < boxes.minX[body2] + boxes.maxX[body2];
+        collisionType = isBody1LeftOfBody2 ? CollisionBodyComponent::Cb1RightEdgeCollidingWithCb2LeftEdge : CollisionBodyComponent::Cb1LeftEdgeCollidingWithCb2RightEdge;
+    } else {
+        auto isBody1AboveBody2 = boxes.minY[body1] + boxes.maxY[body1] < boxes.minY[body2] + boxes.maxY[body2];
+        collisionType = isBody1AboveBody2 ? CollisionBodyComponent::Cb1BottomEdgeCollidingWithCb2TopEdge : CollisionBodyComponent::Cb1TopEdgeCollidingWithCb2BottomEdge;
+    }
+    return true;
+}
+
+simple_2d::CollisionBodyComponentManager::DetectedPair simple_2d::CollisionBodyComponentManager::DetectPair(CollisionBodyIndex body1, CollisionBodyIndex body2) const {
+    DetectedPair detectedPair;
+    // Sensors only report overlaps, whatever the type of the other body
+    if (mBodyIsSensor[body1] || mBodyIsSensor[body2]) {
+        detectedPair.status = mBodyIsSensor[body1] && mBodyIsSensor[body2] ? PAIR_SKIPPED : PAIR_SENSOR;
+        return detectedPair;
+    }
+    // Only dynamic bodies are pushed by collisions. Static and kinematic bodies ignore each other.
+    if (mBodyTypes[body1] != CollisionBodyComponent::Dynamic && mBodyTypes[body2] != CollisionBodyComponent::Dynamic) {
+        detectedPair.status = PAIR_SKIPPED;
+        return detectedPair;
+    }
+    // Swept test of the boxes from this tick to next tick: when they first touch and along which edges. Unlike a test
+    // of the boxes next tick, it catches fast bodies passing through thin ones in a single tick.
+    detectedPair.status = SweepBodies(body1, body2, detectedPair.collisionType) ? PAIR_COLLIDING : PAIR_SEPARATE;
+    return detectedPair;
+}
+
+simple_2d::CollisionBodyComponent::CollisionType simple_2d::CollisionBodyComponentManager::GetOppositeCollisionType(CollisionBodyComponent::CollisionType collisionType) {
+    switch (collisionType) {
+        case CollisionBodyComponent::Cb1BottomEdgeCollidingWithCb2TopEdge:
+            return CollisionBodyComponent::Cb1TopEdgeCollidingWithCb2BottomEdge;
+        case CollisionBodyComponent::Cb1TopEdgeCollidingWithCb2BottomEdge:
+            return CollisionBodyComponent::Cb1BottomEdgeCollidingWithCb2TopEdge;
+        case CollisionBodyComponent::Cb1LeftEdgeCollidingWithCb2RightEdge:
+            return CollisionBodyComponent::Cb1RightEdgeCollidingWithCb2LeftEdge;
+        case CollisionBodyComponent::Cb1RightEdgeCollidingWithCb2LeftEdge:
+            return CollisionBodyComponent::Cb1LeftEdgeCollidingWithCb2RightEdge;
+    }
+    return collisionType;
+}
+
+float simple_2d::CollisionBodyComponentManager::GetCorrectionRatio(float velocity1, float velocity2, bool isDynamic1, bool isDynamic2) {
+    if (!isDynamic2) {
+        return 1;
+    }
+    if (!isDynamic1) {
+        return 0;
+    }
+    // Velocities of opposite signs would give a ratio outside [0, 1], or divide by 0 in a head-on collision
+    auto speed1 = std::abs(velocity1);
+    auto speed2 = std::abs(velocity2);
+    if (speed1 + speed2 == 0) {
+        return 0.5f;
+    }
+    return speed1 / (speed1 + speed2);
+}
+
+void simple_2d::CollisionBodyComponentManager::RefreshBodyBoxes(CollisionBodyIndex body) {
+    if (mBodyTypes[body] == CollisionBodyComponent::Static) {
+        return;
+    }
+    auto collisionBodyComponent = mBodyComponents[body];
+    auto motionComponent = collisionBodyComponent->GetMotion();
+    if (motionComponent == nullptr) {
+        // The motion component was removed by a callback. Keep the last known boxes.
+        return;
+    }
+    auto size = (XYCoordinate<float>)collisionBodyComponent->GetSize();
+    auto collisionBoxTopLeft = motionComponent->GetPosition() + collisionBodyComponent->GetOffset();
+    auto collisionBoxTopLeftNextTick = motionComponent->GetPositionNextTick() + collisionBodyComponent->GetOffset();
+    mBodyBoxes.Set(body, Rectangle<float>({collisionBoxTopLeft, collisionBoxTopLeft + size}));
+    mBodyBoxesNextTick.Set(body, Rectangle<float>({collisionBoxTopLeftNextTick, collisionBoxTopLeftNextTick + size}));
+    mIsBodyMoved[body] = true;
+    auto isInsideSweptBox = mBodySweptBoxes.minX[body] <= mBodyBoxesNextTick.minX[body] && mBodySweptBoxes.minY[body] <= mBodyBoxesNextTick.minY[body] &&
+                            mBodyBoxesNextTick.maxX[body] <= mBodySweptBoxes.maxX[body] && mBodyBoxesNextTick.maxY[body] <= mBodySweptBoxes.maxY[body];
+    if (!isInsideSweptBox && !mIsBodyEscaped[body]) {
+        mIsBodyEscaped[body] = true;
+        mEscapedBodies.push_back(body);
+    }
+}
+
+
+void simple_2d::CollisionBodyComponentManager::BindComponent(CollisionBodyComponent &collisionBodyComponent) {
+    collisionBodyComponent.mManager = this;
+    collisionBodyComponent.BindMotion(&mScene->GetComponentManager<MotionComponent>()->GetStorage());
+}
+
+// Fraction of the segment from start to start + delta at which it enters a box, 0 if it starts inside. Returns false if
+// it misses the box.
+static bool clipSegment(simple_2d::XYCoordinate<float> start, simple_2d::XYCoordinate<float> delta, const simple_2d::AabbBuffer &boxes, simple_2d::CollisionBodyIndex body, float &fraction) {
+    // A point moving by delta against the box
+    float entryX, exitX, entryY, exitY;
+    if (!sweepAxis(start.x, start.x, boxes.minX[body], boxes.maxX[body], delta.x, entryX, exitX) ||
+        !sweepAxis(start.y, start.y, boxes.minY[body], boxes.maxY[body], delta.y, entryY, exitY)) {
+        return false;
+    }
+    auto entry = std::max(entryX, entryY);
+    auto exit = std::min(exitX, exitY);
+    if (!(entry <= exit) || entry > 1 || exit < 0) {
+        return false;
+    }
+    fraction = std::max(entry, 0.0f);
+    return true;
+}
+
+bool simple_2d::CollisionBodyComponentManager::Raycast(XYCoordinate<float> start, XYCoordinate<float> end, RaycastHit &hit, uint32_t maskBits) {
+    hit = RaycastHit();
+    auto delta = end - start;
+    auto getPoint = [&start, &delta](float fraction) {
+        return XYCoordinate<float>(start.x + delta.x * fraction, start.y + delta.y * fraction);
+    };
+    auto length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+    auto numPieces = std::max(1, int(std::ceil(length / RAYCAST_PIECE_LENGTH)));
+    auto hitBody = CollisionBodyIndex(0);
+    auto isHit = false;
+    for (auto piece = 0; piece < numPieces; piece++) {
+        auto pieceStart = getPoint(float(piece) / numPieces);
+        auto pieceEndFraction = float(piece + 1) / numPieces;
+        auto pieceEnd = piece + 1 == numPieces ? end : getPoint(pieceEndFraction);
+        CollectBodies(Rectangle<float>({{std::min(pieceStart.x, pieceEnd.x), std::min(pieceStart.y, pieceEnd.y)}, {std::max(pieceStart.x, pieceEnd.x), std::max(pieceStart.y, pieceEnd.y)}}), maskBits);
+        for (auto body : mQueryBodies) {
+            auto fraction = 0.0f;
+            if (!clipSegment(start, delta, mBodyBoxesNextTick, body, fraction)) {
+                continue;
+            }
+            // Ties go to the first body of the step, so the result does not depend on the broadphase
+            if (!isHit || fraction < hit.fraction || (fraction == hit.fraction && body < hitBody)) {
+                isHit = true;
+                hitBody = body;
+                hit.fraction = fraction;
+            }
+        }
+        // The bodies crossed in the next pieces are crossed later
+        if (isHit && hit.fraction <= pieceEndFraction) {
+            break;
+        }
+    }
+    if (!isHit) {
+        return false;
+    }
+    hit.entityId = mBodyEntities[hitBody];
+    hit.point = getPoint(hit.fraction);
+    return true;
+}
+
+void simple_2d::CollisionBodyComponentManager::QueryRegion(const Rectangle<float> &region, std::vector<EntityId> &entities, uint32_t maskBits) {
+    entities.clear();
+    CollectBodies(region, maskBits);
+    std::sort(mQueryBodies.begin(), mQueryBodies.end());
+    for (auto body : mQueryBodies) {
+        entities.push_back(mBodyEntities[body]);
+    }
+}
+
+void simple_2d::CollisionBodyComponentManager::QueryNearest(XYCoordinate<float> point, size_t k, std::vector<EntityId> &entities, uint32_t maskBits) {
+    entities.clear();
+    if (k == 0 || mBodyEntities.empty()) {
+        return;
+    }
+    // Search squares of growing size around the point. The bodies found within halfSize of the point are certainly the
+    // nearest ones, since any body closer than that overlaps the square.
+    auto halfSize = float(NEAREST_QUERY_HALF_SIZE);
+    while (true) {
+        Rectangle<float> region({{point.x - halfSize, point.y - halfSize}, {point.x + halfSize, point.y + halfSize}});
+        auto isEveryBody = std::isinf(halfSize) || (region.top_left.x <= mBodiesBounds.top_left.x && region.top_left.y <= mBodiesBounds.top_left.y &&
+                                                     mBodiesBounds.bottom_right.x <= region.bottom_right.x && mBodiesBounds.bottom_right.y <= region.bottom_right.y);
+        CollectBodies(region, maskBits);
+        mQueryDistances.clear();
+        for (auto body : mQueryBodies) {
+            auto dx = std::max({mBodyBoxesNextTick.minX[body] - point.x, 0.0f, point.x - mBodyBoxesNextTick.maxX[body]});
+            auto dy = std::max({mBodyBoxesNextTick.minY[body] - point.y, 0.0f, point.y - mBodyBoxesNextTick.maxY[body]});
+            auto squaredDistance = dx * dx + dy * dy;
+            if (isEveryBody || squaredDistance <= halfSize * halfSize) {
+                mQueryDistances.push_back({squaredDistance, body});
+            }
+        }
+        if (isEveryBody || mQueryDistances.size() >= k) {
+            break;
+        }
+        halfSize *= 2;
+    }
+    // Equal distances are ordered by body, so the result does not depend on the broadphase
+    auto count = std::min(k, mQueryDistances.size());
+    std::partial_sort(mQueryDistances.begin(), mQueryDistances.begin() + count, mQueryDistances.end());
+    for (size_t i = 0; i < count; i++) {
+        entities.push_back(mBodyEntities[mQueryDistances[i].second]);
+    }
+}
+
+void simple_2d::CollisionBodyComponentManager::CollectBodies(const Rectangle<float> &region, uint32_t maskBits) {
+    mQueryBodies.clear();
+    if (mBodyEntities.empty()) {
+        return;
+    }
+    mStaticBroadphase->QueryRegion(region, mQueryBodies);
+    mBroadphase->QueryRegion(region, mQueryBodies);
+    // The broadphases return candidates from the swept boxes, keep the bodies whose box overlaps the region
+    auto isInRegion = [this, &region, maskBits](CollisionBodyIndex body) {
+        return (mBodyFilters[body].categoryBits & maskBits) != 0 &&
+               mBodyBoxesNextTick.minX[body] <= region.bottom_right.x && region.top_left.x <= mBodyBoxesNextTick.maxX[body] &&
+               mBodyBoxesNextTick.minY[body] <= region.bottom_right.y && region.top_left.y <= mBodyBoxesNextTick.maxY[body];
+    };
+    mQueryBodies.erase(std::remove_if(mQueryBodies.begin(), mQueryBodies.end(), [this, &isInRegion](CollisionBodyIndex body) {
+        return mIsBodyEscaped[body] || !isInRegion(body);
+    }), mQueryBodies.end());
+    for (auto body : mEscapedBodies) {
+        if (isInRegion(body)) {
+            mQueryBodies.push_back(body);
+        }
+    }
+}
@@ -8,29 +8,26 @@ simple_2d::DownwardGravity::DownwardGravity(EntityId entityId) {
     mEntityId = entityId;
 }
 
-simple_2d::Error simple_2d::DownwardGravity::Step() {
-    auto componentManager = simple_2d::Engine::GetInstance().GetComponentManager(ComponentType::MOTION);
-    if (componentManager == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
-        return Error::NOT_EXISTS;
+simple_2d::Error simple_2d::DownwardGravity::Step(MotionComponent &motion) {
+    // Setting the acceleration would wake a sleeping body up, and a body at rest on the ground does not fall anyway
+    if (!motion.IsAwake()) {
+        return Error::OK;
     }
-    auto component = componentManager->GetComponent(mEntityId);
-    if (component == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << mEntityId;
-        return Error::NOT_EXISTS;
-    }
-    auto motionComponent = std::static_pointer_cast<MotionComponent>(component);
-    motionComponent->SetAccelerationOneAxis(Axis::Y, DEFAULT_GRAVITY);
+    motion.SetAccelerationOneAxis(Axis::Y, DEFAULT_GRAVITY);
     return Error::OK;
 }
 
 simple_2d::DownwardGravityComponentManager::DownwardGravityComponentManager() {
     SetName("downward_gravity");
+    SetComponentAccess({
+        .reads = GetComponentBit(DOWNWARD_GRAVITY) | GetComponentBit(MOTION),
+        .writes = GetComponentBit(MOTION),
+    });
 }
 
 void simple_2d::DownwardGravityComponentManager::DoStep() {
-    for (auto &component : mComponents) {
-        auto downwardGravity = std::static_pointer_cast<DownwardGravity>(component.second);
-        downwardGravity->Step();
-    }
+    // Gravity only applies to entities that can move
+    mScene->View<DownwardGravity, MotionComponent>().ForEach([](EntityId, DownwardGravity &downwardGravity, MotionComponent &motion) {
+        downwardGravity.Step(motion);
+    });
 }
\ No newline at end of file
@@ -23,11 +23,13 @@ simple_2d::Error simple_2d::JsonComponent::Step() {
 
 simple_2d::JsonComponentManager::JsonComponentManager() {
     SetName("json");
+    SetComponentAccess({
+        .reads = GetComponentBit(JSON),
+    });
 }
 
 void simple_2d::JsonComponentManager::DoStep() {
-    for (auto &component : mComponents) {
-        auto jsonComponent = std::static_pointer_cast<JsonComponent>(component.second);
-        jsonComponent->Step();
+    for (auto &jsonComponent : mComponents) {
+        jsonComponent.Step();
     }
 }
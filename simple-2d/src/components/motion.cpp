@@ -1,6 +1,9 @@
 #include <simple-2d/components/motion.h>
 #include <simple-2d/utils.h>
 
+// A motion step is a handful of additions, so chunks must be large for the scheduling cost to pay off
+#define MOTION_CHUNK_SIZE 4096
+
 simple_2d::MotionComponent::MotionComponent(EntityId entityId): mPosition(0, 0), mVelocity(0, 0), mAcceleration(0, 0) {
     SIMPLE_2D_LOG_DEBUG << "MotionComponent constructor " << this;
     mEntityId = entityId;
@@ -11,10 +14,12 @@ simple_2d::MotionComponent::~MotionComponent() {
 }
 
 void simple_2d::MotionComponent::SetPosition(XYCoordinate<float> position) {
+    WakeUpIfChanged(mPosition, position);
     mPosition = position;
 }
 
 void simple_2d::MotionComponent::SetPositionOneAxis(Axis axis, float position) {
+    WakeUpIfChanged(GetPositionOneAxis(axis), position);
     switch (axis) {
         case Axis::X:
             mPosition.x = position;
@@ -26,10 +31,12 @@ void simple_2d::MotionComponent::SetPositionOneAxis(Axis axis, float position) {
 }
 
 void simple_2d::MotionComponent::IncrementPosition(XYCoordinate<float> position) {
+    WakeUpIfChanged(mPosition, mPosition + position);
     mPosition += position;
 }
 
 void simple_2d::MotionComponent::IncrementPositionOneAxis(Axis axis, float position) {
+    WakeUpIfChanged(0.0f, position);
     switch (axis) {
         case Axis::X:
             mPosition.x += position;
@@ -62,10 +69,12 @@ float simple_2d::MotionComponent::GetPositionOneAxis(Axis axis) const {
 }
 
 void simple_2d::MotionComponent::SetVelocity(XYCoordinate<float> velocity) {
+    WakeUpIfChanged(mVelocity, velocity);
     mVelocity = velocity;
 }
 
 void simple_2d::MotionComponent::SetVelocityOneAxis(Axis axis, float velocity) {
+    WakeUpIfChanged(GetVelocityOneAxis(axis), velocity);
     switch (axis) {
         case Axis::X:
             mVelocity.x = velocity;
@@ -101,10 +110,12 @@ float simple_2d::MotionComponent::GetVelocityOneAxis(Axis axis) const {
 }
 
 void simple_2d::MotionComponent::IncrementVelocity(XYCoordinate<float> velocity) {
+    WakeUpIfChanged(mVelocity, mVelocity + velocity);
     mVelocity += velocity;
 }
 
 void simple_2d::MotionComponent::IncrementVelocityOneAxis(Axis axis, float velocity) {
+    WakeUpIfChanged(0.0f, velocity);
     switch (axis) {
         case Axis::X:
             mVelocity.x += velocity;
@@ -116,6 +127,7 @@ void simple_2d::MotionComponent::IncrementVelocityOneAxis(Axis axis, float veloc
 }
 
 void simple_2d::MotionComponent::SetAcceleration(XYCoordinate<float> acceleration) {
+    WakeUpIfChanged(mAcceleration, acceleration);
     mAcceleration = acceleration;
 }
 
@@ -136,10 +148,12 @@ float simple_2d::MotionComponent::GetAccelerationOneAxis(Axis axis) const {
     return ret;
 }
 void simple_2d::MotionComponent::IncrementAcceleration(XYCoordinate<float> acceleration) {
+    WakeUpIfChanged(mAcceleration, mAcceleration + acceleration);
     mAcceleration += acceleration;
 }
 
 void simple_2d::MotionComponent::SetAccelerationOneAxis(Axis axis, float acceleration) {
+    WakeUpIfChanged(GetAccelerationOneAxis(axis), acceleration);
     switch (axis) {
         case Axis::X:
             mAcceleration.x = acceleration;
@@ -150,7 +164,32 @@ void simple_2d::MotionComponent::SetAccelerationOneAxis(Axis axis, float acceler
     }
 }
 
+bool simple_2d::MotionComponent::IsAwake() const {
+    return mIsAwake;
+}
+
+void simple_2d::MotionComponent::WakeUp() {
+    mIsAwake = true;
+}
+
+void simple_2d::MotionComponent::WakeUpIfChanged(float value, float newValue) {
+    mIsAwake = mIsAwake || value != newValue;
+}
+
+void simple_2d::MotionComponent::WakeUpIfChanged(XYCoordinate<float> value, XYCoordinate<float> newValue) {
+    mIsAwake = mIsAwake || value.x != newValue.x || value.y != newValue.y;
+}
+
+void simple_2d::MotionComponent::Sleep() {
+    mVelocity = XYCoordinate<float>(0, 0);
+    mAcceleration = XYCoordinate<float>(0, 0);
+    mIsAwake = false;
+}
+
 simple_2d::Error simple_2d::MotionComponent::Step() {
+    if (!mIsAwake) {
+        return simple_2d::Error::OK;
+    }
     SIMPLE_2D_LOG_DEBUG << "MotionComponent step for entity " << mEntityId;
     mVelocity += mAcceleration;
     mPosition += mVelocity;
@@ -158,13 +197,25 @@ simple_2d::Error simple_2d::MotionComponent::Step() {
     return simple_2d::Error::OK;
 }
 
+void simple_2d::MotionBoundComponent::BindMotion(const PackedComponentStorage<MotionComponent> *motionStorage) {
+    mMotion.Bind(motionStorage, mEntityId);
+}
+
+simple_2d::MotionComponent* simple_2d::MotionBoundComponent::GetMotion() const {
+    return mMotion.Get();
+}
+
 simple_2d::MotionComponentManager::MotionComponentManager() {
     SetName("motion");
+    SetComponentAccess({
+        .reads = GetComponentBit(MOTION),
+        .writes = GetComponentBit(MOTION),
+    });
 }
 
 void simple_2d::MotionComponentManager::DoStep() {
-    for (auto &component : mComponents) {
-        auto motionComponent = std::static_pointer_cast<MotionComponent>(component.second);
-        motionComponent->Step();
-    }
+    // Every motion component only integrates itself, so chunks of the storage can be stepped on different threads
+    ParallelForEach([](MotionComponent &motionComponent) {
+        motionComponent.Step();
+    }, MOTION_CHUNK_SIZE);
 }
@@ -61,18 +61,12 @@ simple_2d::Error simple_2d::StaticRepetitiveSpriteComponent::Step() {
         RebuildTexture();
         mNeedsRebuildTexture = false;
     }
-    auto componentManager = simple_2d::Engine::GetInstance().GetComponentManager(ComponentType::MOTION);
-    if (componentManager == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
-        return Error::NOT_EXISTS;
-    }
-    auto component = componentManager->GetComponent(mEntityId);
-    if (component == nullptr) {
+    auto motion = mMotion.Get();
+    if (motion == nullptr) {
         SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << mEntityId;
         return Error::NOT_EXISTS;
     }
-    auto positionComponent = std::static_pointer_cast<MotionComponent>(component);
-    auto position = positionComponent->GetPosition() + mOffset;
+    auto position = motion->GetPosition() + mOffset;
     simple_2d::Engine::GetInstance().PrepareTextureForRendering(mBuiltTexture, position);
     return Error::OK;
 }
@@ -95,11 +89,20 @@ void simple_2d::StaticRepetitiveSpriteComponent::RebuildTexture() {
 
 simple_2d::StaticRepetitiveSpriteComponentManager::StaticRepetitiveSpriteComponentManager() {
     SetName("static_repetitive_sprite");
+    // Also writes its own components: textures are rebuilt lazily
+    SetComponentAccess({
+        .reads = GetComponentBit(STATIC_REPETITIVE_SPRITE) | GetComponentBit(MOTION),
+        .writes = GetComponentBit(STATIC_REPETITIVE_SPRITE),
+        .resources = RENDER_RESOURCE,
+    });
 }
 
 void simple_2d::StaticRepetitiveSpriteComponentManager::DoStep() {
-    for (auto &component : mComponents) {
-        auto staticRepetitiveSprite = std::static_pointer_cast<StaticRepetitiveSpriteComponent>(component.second);
-        staticRepetitiveSprite->Step();
+    for (auto &staticRepetitiveSprite : mComponents) {
+        staticRepetitiveSprite.Step();
     }
 }
+
+void simple_2d::StaticRepetitiveSpriteComponentManager::BindComponent(StaticRepetitiveSpriteComponent &staticRepetitiveSprite) {
+    staticRepetitiveSprite.BindMotion(&mScene->GetComponentManager<MotionComponent>()->GetStorage());
+}
@@ -31,29 +31,30 @@ simple_2d::XYCoordinate<float> simple_2d::StaticSpriteComponent::GetOffset() con
 }
 
 simple_2d::Error simple_2d::StaticSpriteComponent::Step() {
-    auto componentManager = simple_2d::Engine::GetInstance().GetComponentManager(ComponentType::MOTION);
-    if (componentManager == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
-        return Error::NOT_EXISTS;
-    }
-    auto component = componentManager->GetComponent(mEntityId);
-    if (component == nullptr) {
+    auto motion = mMotion.Get();
+    if (motion == nullptr) {
         SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << mEntityId;
         return Error::NOT_EXISTS;
     }
-    auto positionComponent = std::static_pointer_cast<MotionComponent>(component);
-    auto position = positionComponent->GetPosition() + mOffset;
+    auto position = motion->GetPosition() + mOffset;
     simple_2d::Engine::GetInstance().PrepareTextureForRendering(mTexture, position);
     return simple_2d::Error::OK;
 }
 
 simple_2d::StaticSpriteComponentManager::StaticSpriteComponentManager() {
     SetName("static_sprite");
+    SetComponentAccess({
+        .reads = GetComponentBit(STATIC_SPRITE) | GetComponentBit(MOTION),
+        .resources = RENDER_RESOURCE,
+    });
 }
 
 void simple_2d::StaticSpriteComponentManager::DoStep() {
-    for (auto &component : mComponents) {
-        auto staticSprite = std::static_pointer_cast<StaticSpriteComponent>(component.second);
-        staticSprite->Step();
+    for (auto &staticSprite : mComponents) {
+        staticSprite.Step();
     }
 }
+
+void simple_2d::StaticSpriteComponentManager::BindComponent(StaticSpriteComponent &staticSprite) {
+    staticSprite.BindMotion(&mScene->GetComponentManager<MotionComponent>()->GetStorage());
+}
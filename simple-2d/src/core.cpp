@@ -95,6 +95,10 @@ simple_2d::Camera& simple_2d::Engine::GetCamera() {
     return mCamera;
 }
 
+simple_2d::WorkerPool& simple_2d::Engine::GetWorkerPool() {
+    return mWorkerPool;
+}
+
 simple_2d::Error simple_2d::Engine::PrepareTextureForRendering(const ManagedTexture &texture, XYCoordinate<float> pos) {
     auto translatedPosition = pos - mCamera.GetPosition();
     return mGraphics.PutTextureToBackBuffer(texture, translatedPosition);
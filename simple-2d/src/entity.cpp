@@ -2,9 +2,14 @@
 #include <simple-2d/core.h>
 #include <simple-2d/utils.h>
 
-static simple_2d::EntityId currentEntityId = 0;
-
-simple_2d::Entity::Entity() : mEntityId(currentEntityId++) {
+simple_2d::Entity::Entity() : mEntityId(INVALID_ENTITY_ID) {
+    // Entity ids are allocated by the scene so that they can be recycled once the entity is deleted from it
+    auto scene = Engine::GetInstance().GetCurrentScene();
+    if (scene == nullptr) {
+        SIMPLE_2D_LOG_ERROR << "Cannot create entity without current scene";
+        return;
+    }
+    mEntityId = scene->CreateEntityId();
     SIMPLE_2D_LOG_INFO << "Created entity " << mEntityId;
 }
 
@@ -16,22 +21,25 @@ simple_2d::EntityId simple_2d::Entity::GetEntityId() const {
 }
 
 simple_2d::Error simple_2d::Entity::AddComponent(ComponentType componentType) {
+    if (mEntityId == INVALID_ENTITY_ID) {
+        SIMPLE_2D_LOG_ERROR << "Cannot add component " << componentType << " to an entity without id";
+        return Error::NOT_EXISTS;
+    }
     auto componentManager = Engine::GetInstance().GetComponentManager(componentType);
     if (componentManager == nullptr) {
         SIMPLE_2D_LOG_ERROR << "Failed to get component manager for component " << componentType;
         return Error::NOT_EXISTS;
     }
-    auto component = Component::CreateComponent(componentType, mEntityId);
+    auto component = componentManager->AddComponent(mEntityId);
     if (component == nullptr) {
         SIMPLE_2D_LOG_ERROR << "Failed to create component " << componentType << " for entity " << mEntityId;
         return Error::NOT_EXISTS;
     }
-    componentManager->RegisterNewEntity(mEntityId, component);
     SIMPLE_2D_LOG_INFO << "Added component \"" << componentManager->GetName() << "\" for entity " << mEntityId;
     return Error::OK;
 }
 
-std::shared_ptr<simple_2d::Component> simple_2d::Entity::GetComponent(ComponentType componentType) const {
+simple_2d::Component* simple_2d::Entity::GetComponent(ComponentType componentType) const {
     auto componentManager = Engine::GetInstance().GetComponentManager(componentType);
     if (componentManager == nullptr) {
         SIMPLE_2D_LOG_ERROR << "Failed to get component manager for component " << componentType;
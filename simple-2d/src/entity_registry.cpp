@@ -0,0 +1,64 @@
+#include <simple-2d/entity_registry.h>
+#include <simple-2d/utils.h>
+
+simple_2d::EntityId simple_2d::EntityRegistry::Create() {
+    uint32_t index;
+    // Once no new index can be allocated, the queued ones are reused right away
+    if (mFreeIndices.size() > MIN_FREE_INDICES || (mGenerations.size() >= ENTITY_INDEX_MASK && !mFreeIndices.empty())) {
+        index = mFreeIndices.front();
+        mFreeIndices.pop_front();
+    } else {
+        if (mGenerations.size() >= ENTITY_INDEX_MASK) {
+            SIMPLE_2D_LOG_ERROR << "Run out of entity indices, " << mNumAliveEntities << " entities alive";
+            return INVALID_ENTITY_ID;
+        }
+        index = uint32_t(mGenerations.size());
+        mGenerations.push_back(0);
+        mComponentMasks.push_back(0);
+    }
+    mNumAliveEntities++;
+    return MakeEntityId(index, mGenerations[index]);
+}
+
+void simple_2d::EntityRegistry::Destroy(EntityId id) {
+    if (!IsAlive(id)) {
+        SIMPLE_2D_LOG_WARNING << "Cannot destroy entity " << id << " because it is not alive";
+        return;
+    }
+    auto index = GetEntityIndex(id);
+    mGenerations[index] = (mGenerations[index] + 1) & ENTITY_GENERATION_MASK;
+    mComponentMasks[index] = 0;
+    mFreeIndices.push_back(index);
+    mNumAliveEntities--;
+}
+
+bool simple_2d::EntityRegistry::IsAlive(EntityId id) const {
+    auto index = GetEntityIndex(id);
+    return index < mGenerations.size() && mGenerations[index] == GetEntityGeneration(id);
+}
+
+size_t simple_2d::EntityRegistry::GetNumAliveEntities() const {
+    return mNumAliveEntities;
+}
+
+size_t simple_2d::EntityRegistry::GetIndexCapacity() const {
+    return mGenerations.size();
+}
+
+simple_2d::ComponentMask simple_2d::EntityRegistry::GetComponentMask(EntityId id) const {
+    if (!IsAlive(id)) {
+        return 0;
+    }
+    return mComponentMasks[GetEntityIndex(id)];
+}
+
+void simple_2d::EntityRegistry::SetComponentBit(EntityId id, ComponentType componentType, bool hasComponent) {
+    if (!IsAlive(id)) {
+        return;
+    }
+    if (hasComponent) {
+        mComponentMasks[GetEntityIndex(id)] |= GetComponentBit(componentType);
+    } else {
+        mComponentMasks[GetEntityIndex(id)] &= ~GetComponentBit(componentType);
+    }
+}
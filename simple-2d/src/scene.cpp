@@ -1,5 +1,6 @@
 #include <simple-2d/scene.h>
 #include <simple-2d/utils.h>
+#include <simple-2d/core.h>
 #include <simple-2d/components/behavior_script.h>
 #include <simple-2d/components/downward_gravity.h>
 #include <simple-2d/components/static_sprite.h>
@@ -9,9 +10,42 @@
 #include <simple-2d/components/static_repetitive_sprite.h>
 #include <simple-2d/components/collision_body.h>
 
+namespace {
+    // The order in which managers are stepped when nothing runs in parallel
+    constexpr simple_2d::ComponentType STEP_ORDER[] = {
+        simple_2d::BEHAVIOR_SCRIPT,
+        simple_2d::DOWNWARD_GRAVITY,
+        simple_2d::STATIC_SPRITE,
+        simple_2d::COLLISION_BODY,
+        simple_2d::MOTION,
+        simple_2d::ANIMATED_SPITE,
+        simple_2d::STATIC_REPETITIVE_SPRITE,
+    };
+
+    // Creates the manager of every component type listed. The list must cover the whole ComponentType enum.
+    template<typename... Components>
+    void CreateComponentManagers(simple_2d::Scene *scene, simple_2d::ComponentArena *arena, std::shared_ptr<simple_2d::ComponentManager> (&componentManagers)[simple_2d::MAX_COMPONENT_TYPES]) {
+        static_assert(sizeof...(Components) == simple_2d::MAX_COMPONENT_TYPES - simple_2d::BEGIN_COMPONENT_TYPE - 1,
+                      "Every component type needs a manager");
+        ((componentManagers[simple_2d::ComponentTraits<Components>::TYPE] =
+            std::make_shared<typename simple_2d::ComponentTraits<Components>::Manager>()), ...);
+        ((componentManagers[simple_2d::ComponentTraits<Components>::TYPE]->SetScene(scene, simple_2d::ComponentTraits<Components>::TYPE)), ...);
+        ((componentManagers[simple_2d::ComponentTraits<Components>::TYPE]->SetComponentArena(arena)), ...);
+    }
+}
+
 simple_2d::Scene::Scene(RectangularDimensions<int> dimensions) : mDimensions(dimensions) {
 }
 
+simple_2d::Scene::~Scene() {
+    // Managers may outlive the scene if somebody still holds them, but their components live in the scene's arena
+    for (auto &componentManager : mComponentManagers) {
+        if (componentManager != nullptr) {
+            componentManager->SetComponentArena(nullptr);
+        }
+    }
+}
+
 simple_2d::RectangularDimensions<int> simple_2d::Scene::GetDimensions() const {
     return mDimensions;
 }
@@ -21,14 +55,15 @@ simple_2d::Error simple_2d::Scene::Init() {
         return Error::OK;
     }
     mIsInitialized = true;
-    mComponentManagers[BEHAVIOR_SCRIPT] = std::make_shared<BehaviorScriptComponentManager>();
-    mComponentManagers[DOWNWARD_GRAVITY] = std::make_shared<DownwardGravityComponentManager>();
-    mComponentManagers[STATIC_SPRITE] = std::make_shared<StaticSpriteComponentManager>();
-    mComponentManagers[MOTION] = std::make_shared<MotionComponentManager>();
-    mComponentManagers[ANIMATED_SPITE] = std::make_shared<AnimatedSpriteComponentManager>();
-    mComponentManagers[JSON] = std::make_shared<JsonComponentManager>();
-    mComponentManagers[STATIC_REPETITIVE_SPRITE] = std::make_shared<StaticRepetitiveSpriteComponentManager>();
-    mComponentManagers[COLLISION_BODY] = std::make_shared<CollisionBodyComponentManager>();
+    CreateComponentManagers<BehaviorScript,
+                            DownwardGravity,
+                            StaticSpriteComponent,
+                            MotionComponent,
+                            AnimatedSprite,
+                            JsonComponent,
+                            StaticRepetitiveSpriteComponent,
+                            CollisionBodyComponent>(this, &mComponentArena, mComponentManagers);
+    BuildStepStages();
     return Error::OK;
 }
 
@@ -41,35 +76,123 @@ std::shared_ptr<simple_2d::ComponentManager> simple_2d::Scene::GetComponentManag
 }
 
 simple_2d::Error simple_2d::Scene::Step() {
-    mComponentManagers[BEHAVIOR_SCRIPT]->Step();
-    mComponentManagers[DOWNWARD_GRAVITY]->Step();
-    mComponentManagers[STATIC_SPRITE]->Step();
-    mComponentManagers[COLLISION_BODY]->Step();
-    mComponentManagers[MOTION]->Step();
-    mComponentManagers[ANIMATED_SPITE]->Step();
-    mComponentManagers[STATIC_REPETITIVE_SPRITE]->Step();
+    for (auto &stage : mStepStages) {
+        StepStage(stage);
+    }
     SIMPLE_2D_LOG_DEBUG << "Stepping component managers done";
     // Delete queued entity Id
     // NOTE: I really don't know whether this is good idea for removing entity from scene. I choose
     // this solution because I think that removing it after step through all component manager is better idea
     // than remove enity inside step function
-    for (auto &entityId: mEntityIdsToDelete) {
-        // To remove entity is simple: just remove every component of that entity
-        // RemoveEntity a non-existing component of entity is OK
-        mComponentManagers[BEHAVIOR_SCRIPT]->RemoveComponentOfEntity(entityId);
-        mComponentManagers[DOWNWARD_GRAVITY]->RemoveComponentOfEntity(entityId);
-        mComponentManagers[STATIC_SPRITE]->RemoveComponentOfEntity(entityId);
-        mComponentManagers[COLLISION_BODY]->RemoveComponentOfEntity(entityId);
-        mComponentManagers[MOTION]->RemoveComponentOfEntity(entityId);
-        mComponentManagers[ANIMATED_SPITE]->RemoveComponentOfEntity(entityId);
-        mComponentManagers[STATIC_REPETITIVE_SPRITE]->RemoveComponentOfEntity(entityId);
+    // To remove entity is simple: just remove every component of that entity, then release its id. Deletions are batched
+    // per manager, and the component masks tell which managers hold each entity, so managers holding none are skipped.
+    ComponentMask deletedComponents = 0;
+    for (auto entityId: mEntityIdsToDelete) {
+        deletedComponents |= mEntityRegistry.GetComponentMask(entityId);
+    }
+    for (int componentType = BEGIN_COMPONENT_TYPE + 1; componentType < MAX_COMPONENT_TYPES; componentType++) {
+        auto componentBit = GetComponentBit(ComponentType(componentType));
+        if ((deletedComponents & componentBit) == 0) {
+            continue;
+        }
+        auto &componentManager = mComponentManagers[componentType];
+        for (auto entityId: mEntityIdsToDelete) {
+            // Removing the component clears its bit, so an entity requested to be deleted more than once in a tick is
+            // only removed once
+            if (mEntityRegistry.GetComponentMask(entityId) & componentBit) {
+                componentManager->RemoveComponentOfEntity(entityId);
+            }
+        }
+    }
+    for (auto entityId: mEntityIdsToDelete) {
+        if (mEntityRegistry.IsAlive(entityId)) {
+            mEntityRegistry.Destroy(entityId);
+        }
     }
     mEntityIdsToDelete.clear();
     return Error::OK;
 }
 
 
+simple_2d::EntityId simple_2d::Scene::CreateEntityId() {
+    return mEntityRegistry.Create();
+}
+
+bool simple_2d::Scene::IsEntityAlive(EntityId entityId) const {
+    return mEntityRegistry.IsAlive(entityId);
+}
+
 void simple_2d::Scene::RequestDeleteEntity(EntityId entityId) {
+    if (!mEntityRegistry.IsAlive(entityId)) {
+        SIMPLE_2D_LOG_WARNING << "Request delete entity " << entityId << " which is already deleted";
+        return;
+    }
     SIMPLE_2D_LOG_DEBUG << "Request delete entity " << entityId;
     mEntityIdsToDelete.push_back(entityId);
 }
+
+simple_2d::ComponentMask simple_2d::Scene::GetComponentMask(EntityId entityId) const {
+    return mEntityRegistry.GetComponentMask(entityId);
+}
+
+void simple_2d::Scene::SetComponentBit(EntityId entityId, ComponentType componentType, bool hasComponent) {
+    mEntityRegistry.SetComponentBit(entityId, componentType, hasComponent);
+}
+
+void simple_2d::Scene::BuildStepStages() {
+    mStepStages.clear();
+    std::vector<size_t> stageOfStepped;
+    for (size_t i = 0; i < std::size(STEP_ORDER); i++) {
+        auto &access = mComponentManagers[STEP_ORDER[i]]->GetComponentAccess();
+        size_t stage = 0;
+        for (size_t j = 0; j < i; j++) {
+            if (access.ConflictsWith(mComponentManagers[STEP_ORDER[j]]->GetComponentAccess())) {
+                stage = std::max(stage, stageOfStepped[j] + 1);
+            }
+        }
+        stageOfStepped.push_back(stage);
+        if (stage >= mStepStages.size()) {
+            mStepStages.resize(stage + 1);
+        }
+        mStepStages[stage].push_back(STEP_ORDER[i]);
+    }
+    for (size_t stage = 0; stage < mStepStages.size(); stage++) {
+        std::string names;
+        for (auto componentType : mStepStages[stage]) {
+            names += ' ';
+            names += mComponentManagers[componentType]->GetName();
+        }
+        SIMPLE_2D_LOG_INFO << "Step stage " << stage << ":" << names;
+    }
+}
+
+void simple_2d::Scene::StepStage(const std::vector<ComponentType> &stage) {
+    if (stage.size() == 1) {
+        mComponentManagers[stage[0]]->Step();
+        return;
+    }
+    // Managers using the renderer stay on this thread. There is at most one per stage since they conflict with each other.
+    auto &workerPool = Engine::GetInstance().GetWorkerPool();
+    WorkerPool::TaskGroup group;
+    ComponentManager *renderingManager = nullptr;
+    for (auto componentType : stage) {
+        auto componentManager = mComponentManagers[componentType].get();
+        if (componentManager->GetComponentAccess().resources & RENDER_RESOURCE) {
+            renderingManager = componentManager;
+            continue;
+        }
+        workerPool.Submit(group, [componentManager] { componentManager->Step(); });
+    }
+    if (renderingManager != nullptr) {
+        renderingManager->Step();
+    }
+    workerPool.Wait(group);
+}
+
+simple_2d::ComponentMemoryStats simple_2d::Scene::GetComponentMemoryStats(ComponentType componentType) const {
+    return mComponentArena.GetStats(componentType);
+}
+
+size_t simple_2d::Scene::GetComponentMemoryReserved() const {
+    return mComponentArena.GetReservedBytes();
+}
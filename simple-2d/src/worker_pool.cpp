@@ -0,0 +1,178 @@
+#include <simple-2d/worker_pool.h>
+#include <simple-2d/utils.h>
+#include <algorithm>
+
+namespace {
+    // Pool and queue index of the current thread, so that a task submitting more tasks pushes them to its own queue
+    thread_local const simple_2d::WorkerPool *tCurrentPool = nullptr;
+    thread_local size_t tCurrentQueueIndex = 0;
+}
+
+simple_2d::WorkerPool::WorkerPool() : mNumThreads(std::max(1u, std::thread::hardware_concurrency())) {
+}
+
+simple_2d::WorkerPool::~WorkerPool() {
+    Stop();
+}
+
+void simple_2d::WorkerPool::SetNumThreads(size_t numThreads) {
+    Stop();
+    mNumThreads = std::max<size_t>(1, numThreads);
+    SIMPLE_2D_LOG_INFO << "Worker pool uses " << mNumThreads << " threads";
+}
+
+size_t simple_2d::WorkerPool::GetNumThreads() const {
+    return mNumThreads;
+}
+
+void simple_2d::WorkerPool::Submit(TaskGroup &group, std::function<void()> task) {
+    if (mNumThreads == 1) {
+        // Nobody else would run it: do it now and skip the queue
+        task();
+        return;
+    }
+    if (mThreads.empty()) {
+        Start();
+    }
+    group.mNumPendingTasks++;
+    CountQueued(1);
+    auto &queue = *mQueues[GetOwnQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back({std::move(task), &group});
+    }
+    mWakeUp.notify_one();
+}
+
+void simple_2d::WorkerPool::SubmitBatch(TaskGroup &group, std::vector<std::function<void()>> &tasks) {
+    if (mThreads.empty()) {
+        Start();
+    }
+    group.mNumPendingTasks += tasks.size();
+    CountQueued(tasks.size());
+    auto &queue = *mQueues[GetOwnQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        // Pushed in reverse so that the owner, popping from the back, runs the chunks in order while thieves take the
+        // last chunks from the front
+        for (auto it = tasks.rbegin(); it != tasks.rend(); it++) {
+            queue.tasks.push_back({std::move(*it), &group});
+        }
+    }
+    mWakeUp.notify_all();
+}
+
+void simple_2d::WorkerPool::Wait(TaskGroup &group) {
+    auto ownQueueIndex = GetOwnQueueIndex();
+    Task task;
+    while (group.mNumPendingTasks > 0) {
+        if (FindTask(ownQueueIndex, task)) {
+            RunTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeUp.wait(lock, [this, &group] { return group.mNumPendingTasks == 0 || mNumQueuedTasks > 0; });
+    }
+}
+
+size_t simple_2d::WorkerPool::GetChunkSize(size_t count, const ParallelForOptions &options) const {
+    if (options.chunkSize > 0) {
+        return options.chunkSize;
+    }
+    if (options.isDeterministic) {
+        return DEFAULT_CHUNK_SIZE;
+    }
+    // A few chunks per thread, so that stealing can even out uneven chunks
+    return std::max<size_t>(1, count / (mNumThreads * 4));
+}
+
+void simple_2d::WorkerPool::Start() {
+    mIsStopping = false;
+    mQueues.clear();
+    for (size_t i = 0; i < mNumThreads; i++) {
+        mQueues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (size_t i = 1; i < mNumThreads; i++) {
+        mThreads.emplace_back(&WorkerPool::WorkerLoop, this, i);
+    }
+}
+
+void simple_2d::WorkerPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mIsStopping = true;
+    }
+    mWakeUp.notify_all();
+    for (auto &thread : mThreads) {
+        thread.join();
+    }
+    mThreads.clear();
+}
+
+void simple_2d::WorkerPool::WorkerLoop(size_t queueIndex) {
+    tCurrentPool = this;
+    tCurrentQueueIndex = queueIndex;
+    Task task;
+    while (true) {
+        if (FindTask(queueIndex, task)) {
+            RunTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeUp.wait(lock, [this] { return mIsStopping || mNumQueuedTasks > 0; });
+        if (mIsStopping && mNumQueuedTasks == 0) {
+            return;
+        }
+    }
+}
+
+size_t simple_2d::WorkerPool::GetOwnQueueIndex() const {
+    return tCurrentPool == this ? tCurrentQueueIndex : 0;
+}
+
+bool simple_2d::WorkerPool::FindTask(size_t ownQueueIndex, Task &task) {
+    if (mNumQueuedTasks == 0) {
+        return false;
+    }
+    {
+        auto &queue = *mQueues[ownQueueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            mNumQueuedTasks--;
+            return true;
+        }
+    }
+    // Steal, starting with the next queue so that thieves spread over the victims
+    for (size_t i = 1; i < mQueues.size(); i++) {
+        auto &queue = *mQueues[(ownQueueIndex + i) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            mNumQueuedTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void simple_2d::WorkerPool::RunTask(Task &task) {
+    task.function();
+    if (--task.group->mNumPendingTasks == 0) {
+        {
+            // Taking the lock orders this with a waiter checking the count before sleeping, so the wake up is not lost
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+        }
+        // The group's waiter shares the condition variable with idle threads, so everybody is woken up
+        mWakeUp.notify_all();
+    }
+}
+
+void simple_2d::WorkerPool::CountQueued(size_t numTasks) {
+    // Counted before the tasks are pushed, so the count never goes below the number of tasks in the queues. Changed under
+    // the lock so that a thread about to sleep cannot miss it.
+    std::lock_guard<std::mutex> lock(mSleepMutex);
+    mNumQueuedTasks += numTasks;
+}
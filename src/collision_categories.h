@@ -0,0 +1,12 @@
+#ifndef COLLISION_CATEGORIES_H
+#define COLLISION_CATEGORIES_H
+#include <cstdint>
+
+// Collision categories of the entities of the game, see simple_2d::CollisionFilter
+enum CollisionCategory : uint32_t {
+    PLAYER_COLLISION_CATEGORY = 1 << 0,
+    GROUND_COLLISION_CATEGORY = 1 << 1,
+    ENEMY_COLLISION_CATEGORY = 1 << 2,
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <simple-2d/components/behavior_script.h>
 #include <simple-2d/components/json.h>
 #include <simple-2d/components/collision_body.h>
+#include "collision_categories.h"
 
 #define MOVE_SPEED_PER_TICKS 2
 #define JUMP_INITIAL_SPEED_WHEN_PLAYER_HIT_HEAD 6
@@ -43,7 +44,7 @@ simple_2d::Error Enemy::Init() {
         SIMPLE_2D_LOG_ERROR << "Failed to add behaviro_script component";
         return error;
     }
-    auto animatedSprite = std::static_pointer_cast<simple_2d::AnimatedSprite>(GetComponent(simple_2d::ComponentType::ANIMATED_SPITE));
+    auto animatedSprite = GetComponent<simple_2d::AnimatedSprite>();
     auto bitmap = engine.GetGraphics().LoadImageFromFile("assets/player_idle_1.png");
     animatedSprite->AddAnimation(0, bitmap.texture, 5);
     bitmap = engine.GetGraphics().LoadImageFromFile("assets/player_idle_2.png");
@@ -51,35 +52,37 @@ simple_2d::Error Enemy::Init() {
     bitmap = engine.GetGraphics().LoadImageFromFile("assets/player_idle_3.png");
     animatedSprite->AddAnimation(0, bitmap.texture, 5);
     animatedSprite->PlayAnimation(0);
-    auto motion = std::static_pointer_cast<simple_2d::MotionComponent>(GetComponent(simple_2d::ComponentType::MOTION));
+    auto motion = GetComponent<simple_2d::MotionComponent>();
     motion->SetPosition(simple_2d::XYCoordinate<float>(600, 200));
     motion->SetVelocityOneAxis(simple_2d::Axis::X, -MOVE_SPEED_PER_TICKS);
-    auto json = std::static_pointer_cast<simple_2d::JsonComponent>(GetComponent(simple_2d::ComponentType::JSON));
+    auto json = GetComponent<simple_2d::JsonComponent>();
     json->SetJson(nlohmann::json::parse(R"(
         {
             "type": "enemy",
             "is_dead": true
         }
     )"));
-    auto collisionBody = std::static_pointer_cast<simple_2d::CollisionBodyComponent>(GetComponent(simple_2d::ComponentType::COLLISION_BODY));
+    auto collisionBody = GetComponent<simple_2d::CollisionBodyComponent>();
     // @TODO: Very hard-cody. Will use another method to get size of sprite then apply to collision body
     collisionBody->SetSize(simple_2d::RectangularDimensions<float>(60, 112));
     collisionBody->SetEnabled(true);
+    // Enemies walk through each other
+    collisionBody->SetCategoryBits(ENEMY_COLLISION_CATEGORY);
+    collisionBody->SetMaskBits(GROUND_COLLISION_CATEGORY | PLAYER_COLLISION_CATEGORY);
     collisionBody->SetOnCollisionCallback([](simple_2d::EntityId entityId1, simple_2d::EntityId entityId2, simple_2d::CollisionBodyComponent::CollisionType collisionType) {
         SIMPLE_2D_LOG_INFO << "Enemy collide with entity " << entityId2;
         auto &engine = simple_2d::Engine::GetInstance();
-        auto jsonComponent1 = std::static_pointer_cast<simple_2d::JsonComponent>(engine.GetComponentManager(simple_2d::ComponentType::JSON)->GetComponent(entityId1));
-        auto jsonComponent2 = std::static_pointer_cast<simple_2d::JsonComponent>(engine.GetComponentManager(simple_2d::ComponentType::JSON)->GetComponent(entityId2));
-        auto jsonData1 = jsonComponent1->GetJson();
-        auto jsonData2 = jsonComponent2->GetJson();
-        if (jsonData2.contains("type") && jsonData2["type"] == "player") {
+        auto categoryBits2 = engine.GetComponent<simple_2d::CollisionBodyComponent>(entityId2)->GetCategoryBits();
+        if (categoryBits2 & PLAYER_COLLISION_CATEGORY) {
             SIMPLE_2D_LOG_INFO << "Enemy hit player";
             if (collisionType != simple_2d::CollisionBodyComponent::CollisionType::Cb1TopEdgeCollidingWithCb2BottomEdge) {
                 // simple this is the case that player will die
                 return;
             }
-            auto motionComponent1 = std::static_pointer_cast<simple_2d::MotionComponent>(engine.GetComponentManager(simple_2d::ComponentType::MOTION)->GetComponent(entityId1));
-            auto collisionBody1 = std::static_pointer_cast<simple_2d::CollisionBodyComponent>(engine.GetComponentManager(simple_2d::ComponentType::COLLISION_BODY)->GetComponent(entityId1));
+            auto jsonComponent1 = engine.GetComponent<simple_2d::JsonComponent>(entityId1);
+            auto jsonData1 = jsonComponent1->GetJson();
+            auto motionComponent1 = engine.GetComponent<simple_2d::MotionComponent>(entityId1);
+            auto collisionBody1 = engine.GetComponent<simple_2d::CollisionBodyComponent>(entityId1);
             collisionBody1->SetEnabled(false);
             motionComponent1->SetVelocityOneAxis(simple_2d::Axis::Y, -JUMP_INITIAL_SPEED_WHEN_PLAYER_HIT_HEAD);
             SIMPLE_2D_LOG_INFO << "Enemy is dead";
@@ -87,15 +90,15 @@ simple_2d::Error Enemy::Init() {
         }
     });
     // This ontick callback is simple for cleaning up enemy if they're dead and fall to certain distance
-    auto behaviorScript = std::static_pointer_cast<simple_2d::BehaviorScript>(GetComponent(simple_2d::ComponentType::BEHAVIOR_SCRIPT));
+    auto behaviorScript = GetComponent<simple_2d::BehaviorScript>();
     behaviorScript->SetOnTickEventCallback([](simple_2d::EntityId entityId){\
         auto &engine = simple_2d::Engine::GetInstance();
-        auto jsonComponent = std::static_pointer_cast<simple_2d::JsonComponent>(engine.GetComponentManager(simple_2d::ComponentType::JSON)->GetComponent(entityId));
+        auto jsonComponent = engine.GetComponent<simple_2d::JsonComponent>(entityId);
         auto jsonData = jsonComponent->GetJson();
         if (!jsonData["is_dead"]) {
             return;
         }
-        auto motionComponent = std::static_pointer_cast<simple_2d::MotionComponent>(engine.GetComponentManager(simple_2d::ComponentType::MOTION)->GetComponent(entityId));
+        auto motionComponent = engine.GetComponent<simple_2d::MotionComponent>(entityId);
         auto posY = motionComponent->GetPositionOneAxis(simple_2d::Axis::Y);
         SIMPLE_2D_LOG_DEBUG << "Position of enemy is " << posY;
         if (posY > 500) {
@@ -5,6 +5,7 @@
 #include <simple-2d/components/collision_body.h>
 #include <simple-2d/components/json.h>
 #include <simple-2d/utils.h>
+#include "collision_categories.h"
 
 simple_2d::Error Ground::Init() {
     auto &engine = simple_2d::Engine::GetInstance();
@@ -28,17 +29,20 @@ simple_2d::Error Ground::Init() {
         SIMPLE_2D_LOG_ERROR << "Failed to add json component";
         return error;
     }
-    auto jsonComponent = std::static_pointer_cast<simple_2d::JsonComponent>(GetComponent(simple_2d::ComponentType::JSON));
+    auto jsonComponent = GetComponent<simple_2d::JsonComponent>();
     jsonComponent->SetJson(nlohmann::json::object({{"type", "ground"}}));
     auto groundBitmapBundle = engine.GetGraphics().LoadImageFromFile("assets/ground_tile.png");
-    auto repetitiveSprite = std::static_pointer_cast<simple_2d::StaticRepetitiveSpriteComponent>(GetComponent(simple_2d::ComponentType::STATIC_REPETITIVE_SPRITE));
+    auto repetitiveSprite = GetComponent<simple_2d::StaticRepetitiveSpriteComponent>();
     repetitiveSprite->SetUnitSurface(groundBitmapBundle.surface);
     repetitiveSprite->SetDimensions(simple_2d::RectangularDimensions<int>(1024, 128));
-    auto motion = std::static_pointer_cast<simple_2d::MotionComponent>(GetComponent(simple_2d::ComponentType::MOTION));
+    auto motion = GetComponent<simple_2d::MotionComponent>();
     motion->SetPosition(simple_2d::XYCoordinate<float>(100, 400));
-    auto collisionBody = std::static_pointer_cast<simple_2d::CollisionBodyComponent>(GetComponent(simple_2d::ComponentType::COLLISION_BODY));
+    auto collisionBody = GetComponent<simple_2d::CollisionBodyComponent>();
     collisionBody->SetSize(simple_2d::RectangularDimensions<float>(1024, 128));
     collisionBody->SetEnabled(true);
+    // The ground never moves
+    collisionBody->SetBodyType(simple_2d::CollisionBodyComponent::Static);
+    collisionBody->SetCategoryBits(GROUND_COLLISION_CATEGORY);
     return simple_2d::Error::OK;
 }
 
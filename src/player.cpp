@@ -7,6 +7,7 @@
 #include <simple-2d/components/behavior_script.h>
 #include <simple-2d/components/json.h>
 #include <simple-2d/components/collision_body.h>
+#include "collision_categories.h"
 
 #define MOVE_SPEED_PER_TICKS 3
 #define JUMP_INITIAL_SPEED 10
@@ -14,7 +15,7 @@
 
 static void onKeyPressedEvent(simple_2d::EntityId entityId, const SDL_Event& event) {
     auto &engine = simple_2d::Engine::GetInstance();
-    auto json = std::static_pointer_cast<simple_2d::JsonComponent>(engine.GetComponentManager(simple_2d::ComponentType::JSON)->GetComponent(entityId));
+    auto json = engine.GetComponent<simple_2d::JsonComponent>(entityId);
     auto jsonData = json->GetJson();
     SIMPLE_2D_LOG_DEBUG << "Key pressed event";
     if (event.key.scancode == SDL_SCANCODE_LEFT) {
@@ -30,7 +31,7 @@ static void onKeyPressedEvent(simple_2d::EntityId entityId, const SDL_Event& eve
 static void onKeyReleasedEvent(simple_2d::EntityId entityId, const SDL_Event& event) {
     auto &engine = simple_2d::Engine::GetInstance();
     SIMPLE_2D_LOG_DEBUG << "Key released event";
-    auto json = std::static_pointer_cast<simple_2d::JsonComponent>(engine.GetComponentManager(simple_2d::ComponentType::JSON)->GetComponent(entityId));
+    auto json = engine.GetComponent<simple_2d::JsonComponent>(entityId);
     auto jsonData = json->GetJson();
     if (event.key.scancode == SDL_SCANCODE_SPACE) {
         jsonData["wantToJump"] = true;
@@ -44,20 +45,14 @@ static void onKeyReleasedEvent(simple_2d::EntityId entityId, const SDL_Event& ev
 
 static void onTickEvent(simple_2d::EntityId entityId) {
     auto &engine = simple_2d::Engine::GetInstance();
-    auto json = std::static_pointer_cast<simple_2d::JsonComponent>(engine.GetComponentManager(simple_2d::ComponentType::JSON)->GetComponent(entityId));
+    auto json = engine.GetComponent<simple_2d::JsonComponent>(entityId);
     auto jsonData = json->GetJson();
     SIMPLE_2D_LOG_DEBUG << "Tick event";
-    auto motionComponentManager = simple_2d::Engine::GetInstance().GetComponentManager(simple_2d::ComponentType::MOTION);
-    if (motionComponentManager == nullptr) {
-        SIMPLE_2D_LOG_ERROR << "Failed to get motion component manager";
-        return;
-    }
-    auto component = motionComponentManager->GetComponent(entityId);
-    if (component == nullptr) {
+    auto motionComponent = engine.GetComponent<simple_2d::MotionComponent>(entityId);
+    if (motionComponent == nullptr) {
         SIMPLE_2D_LOG_ERROR << "Failed to get motion component for entity " << entityId;
         return;
     }
-    auto motionComponent = std::static_pointer_cast<simple_2d::MotionComponent>(component);
     bool isMovingRight = jsonData["isMovingRight"];
     bool isMovingLeft = jsonData["isMovingLeft"];
     bool wantToJump = jsonData["wantToJump"];
@@ -108,7 +103,7 @@ simple_2d::Error Player::Init() {
         SIMPLE_2D_LOG_ERROR << "Failed to add collision_body component";
         return error;
     }
-    auto animatedSprite = std::static_pointer_cast<simple_2d::AnimatedSprite>(GetComponent(simple_2d::ComponentType::ANIMATED_SPITE));
+    auto animatedSprite = GetComponent<simple_2d::AnimatedSprite>();
     auto bitmap = engine.GetGraphics().LoadImageFromFile("assets/player_idle_1.png");
     animatedSprite->AddAnimation(0, bitmap.texture, 5);
     bitmap = engine.GetGraphics().LoadImageFromFile("assets/player_idle_2.png");
@@ -116,9 +111,9 @@ simple_2d::Error Player::Init() {
     bitmap = engine.GetGraphics().LoadImageFromFile("assets/player_idle_3.png");
     animatedSprite->AddAnimation(0, bitmap.texture, 5);
     animatedSprite->PlayAnimation(0);
-    auto motion = std::static_pointer_cast<simple_2d::MotionComponent>(GetComponent(simple_2d::ComponentType::MOTION));
+    auto motion = GetComponent<simple_2d::MotionComponent>();
     motion->SetPosition(simple_2d::XYCoordinate<float>(200, 200));
-    auto json = std::static_pointer_cast<simple_2d::JsonComponent>(GetComponent(simple_2d::ComponentType::JSON));
+    auto json = GetComponent<simple_2d::JsonComponent>();
     json->SetJson(nlohmann::json::parse(R"(
         {
             "isMovingLeft": false,
@@ -128,32 +123,31 @@ simple_2d::Error Player::Init() {
             "type": "player"
         }
     )"));
-    auto behaviorScript = std::static_pointer_cast<simple_2d::BehaviorScript>(GetComponent(simple_2d::ComponentType::BEHAVIOR_SCRIPT));
+    auto behaviorScript = GetComponent<simple_2d::BehaviorScript>();
     behaviorScript->SetOnKeyPressedEventCallback(onKeyPressedEvent);
     behaviorScript->SetOnKeyReleasedEventCallback(onKeyReleasedEvent);
     behaviorScript->SetOnTickEventCallback(onTickEvent);
-    auto collisionBody = std::static_pointer_cast<simple_2d::CollisionBodyComponent>(GetComponent(simple_2d::ComponentType::COLLISION_BODY));
+    auto collisionBody = GetComponent<simple_2d::CollisionBodyComponent>();
     // @TODO: Very hard-cody. Will use another method to get size of sprite then apply to collision body
     collisionBody->SetSize(simple_2d::RectangularDimensions<float>(60, 112));
     collisionBody->SetEnabled(true);
-    collisionBody->SetOnCollisionCallback([](simple_2d::EntityId entityId1, simple_2d::EntityId entityId2, simple_2d::CollisionBodyComponent::CollisionType collisionType) {
+    collisionBody->SetCategoryBits(PLAYER_COLLISION_CATEGORY);
+    collisionBody->SetMaskBits(GROUND_COLLISION_CATEGORY | ENEMY_COLLISION_CATEGORY);
+    // Only the first tick of a contact matters: landing on the ground or hitting an enemy, not standing on the ground
+    collisionBody->SetOnCollisionEnterCallback([](simple_2d::EntityId entityId1, simple_2d::EntityId entityId2, simple_2d::CollisionBodyComponent::CollisionType collisionType) {
         SIMPLE_2D_LOG_INFO << "Player collide with entity " << entityId2;
         auto &engine = simple_2d::Engine::GetInstance();
-        auto jsonComponent1 = std::static_pointer_cast<simple_2d::JsonComponent>(engine.GetComponentManager(simple_2d::ComponentType::JSON)->GetComponent(entityId1));
-        auto jsonComponent2 = std::static_pointer_cast<simple_2d::JsonComponent>(engine.GetComponentManager(simple_2d::ComponentType::JSON)->GetComponent(entityId2));
-        if (jsonComponent2 == nullptr) {
-            // Collide with uninteresting entity, do nothing
-            return;
-        }
-        auto jsonData1 = jsonComponent1->GetJson();
-        auto jsonData2 = jsonComponent2->GetJson();
-        if (jsonData2.contains("type") && jsonData2["type"] == "ground") {
+        // The mask only lets the ground and enemies through
+        auto categoryBits2 = engine.GetComponent<simple_2d::CollisionBodyComponent>(entityId2)->GetCategoryBits();
+        if (categoryBits2 & GROUND_COLLISION_CATEGORY) {
+            auto jsonComponent1 = engine.GetComponent<simple_2d::JsonComponent>(entityId1);
+            auto jsonData1 = jsonComponent1->GetJson();
             jsonData1["isJumping"] = false;
             jsonComponent1->SetJson(jsonData1);
             SIMPLE_2D_LOG_INFO << "Player is not jumping anymore";
-        } else if (jsonData2.contains("type") && jsonData2["type"] == "enemy") {
-            auto motionComponent1 = std::static_pointer_cast<simple_2d::MotionComponent>(engine.GetComponentManager(simple_2d::ComponentType::MOTION)->GetComponent(entityId1));
-            auto collisionBody1 = std::static_pointer_cast<simple_2d::CollisionBodyComponent>(engine.GetComponentManager(simple_2d::ComponentType::COLLISION_BODY)->GetComponent(entityId1));
+        } else if (categoryBits2 & ENEMY_COLLISION_CATEGORY) {
+            auto motionComponent1 = engine.GetComponent<simple_2d::MotionComponent>(entityId1);
+            auto collisionBody1 = engine.GetComponent<simple_2d::CollisionBodyComponent>(entityId1);
             switch (collisionType) {
                 case simple_2d::CollisionBodyComponent::CollisionType::Cb1BottomEdgeCollidingWithCb2TopEdge:
                     motionComponent1->SetVelocityOneAxis(simple_2d::Axis::Y, -JUMP_INITIAL_SPEED_WHEN_HIT_ENEMY);